@@ -0,0 +1,180 @@
+#include <catch2/catch_all.hpp>
+
+// std
+#include <string>
+#include <thread>
+#include <vector>
+
+// libs
+#include <vecs/command_buffer.hpp>
+
+namespace {
+
+struct Position {
+    float x{}, y{};
+};
+
+struct Label {
+    std::string text{}; // Not trivially relocatable, must stay put in the arena.
+};
+
+struct Poisoned {
+    static constexpr vecs::ComponentStorage STORAGE = vecs::ComponentStorage::Sparse;
+    int damage{};
+};
+
+struct Tracked {
+    static inline int alive {};
+
+    Tracked() { ++alive; }
+    Tracked(Tracked&&) noexcept { ++alive; }
+    Tracked& operator=(Tracked&&) noexcept = default;
+    ~Tracked() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("CommandBuffer defers structural changes while iterating", "[command_buffer]") {
+    vecs::World world;
+    std::vector<vecs::Entity> entities{};
+
+    for (int i{}; i < 100; ++i) {
+        auto const entity = world.create_entity();
+        world.add_component(entity, Position { static_cast<float>(i), 0.0f });
+        entities.push_back(entity);
+    }
+
+    vecs::CommandBuffer commands;
+
+    world.each<Position const>([&](vecs::EntityId e, Position const& p) {
+        auto const entity = world.entity(e);
+        REQUIRE(entity == entities[e]);
+
+        if (e % 2 == 0) {
+            commands.add_component(entity, Label { "label of an even entity, too long for SSO " + std::to_string(e) });
+        }
+
+        if (e % 5 == 0) {
+            commands.emplace_component<Poisoned>(entity, static_cast<int>(p.x));
+        }
+
+        if (e % 10 == 0) {
+            commands.destroy_entity(entity);
+        }
+    });
+
+    auto const spawned = commands.create_entity();
+    commands.add_component(spawned, Position { -1.0f, -1.0f });
+    commands.add_component(spawned, Label { "spawned" });
+
+    REQUIRE_FALSE(world.has_component<Label>(entities[2]));
+
+    auto const created = commands.apply(world);
+    REQUIRE(commands.empty());
+    REQUIRE(created.size() == 1);
+    REQUIRE(created[0].index() == 100);
+
+    REQUIRE(world.entity_count() == 91);
+    REQUIRE_FALSE(world.is_alive(entities[20]));
+    REQUIRE(world.get_component<Label>(entities[2])->text.ends_with(" 2"));
+    REQUIRE_FALSE(world.has_component<Label>(entities[3]));
+    REQUIRE(world.get_component<Poisoned>(entities[15])->damage == 15);
+    REQUIRE(world.get_component<Position>(created[0])->x == -1.0f);
+    REQUIRE(world.get_component<Label>(created[0])->text == "spawned");
+
+    // Same type keeps its order, commands on stale handles are dropped.
+    commands.add_component(entities[1], Poisoned { 1 });
+    commands.remove_component<Poisoned>(entities[1]);
+    commands.add_component(entities[3], Poisoned { 1 });
+    commands.add_component(entities[3], Poisoned { 2 });
+    commands.add_component(entities[20], Position {});
+    commands.apply(world);
+
+    REQUIRE_FALSE(world.has_component<Poisoned>(entities[1]));
+    REQUIRE(world.get_component<Poisoned>(entities[3])->damage == 2);
+    REQUIRE(world.entity_count() == 91);
+}
+
+TEST_CASE("CommandBuffer owns payloads until they are applied", "[command_buffer]") {
+    {
+        vecs::World world;
+        auto const entity = world.create_entity();
+        auto const stale = world.create_entity();
+        world.destroy_entity(stale);
+
+        {
+            vecs::CommandBuffer commands;
+
+            // Spans several arena blocks.
+            for (size_t i{}; i < 2 * vecs::CommandBuffer::BLOCK_SIZE; ++i) {
+                commands.emplace_component<Tracked>(entity);
+            }
+
+            commands.emplace_component<Tracked>(stale);
+            REQUIRE(Tracked::alive == static_cast<int>(2 * vecs::CommandBuffer::BLOCK_SIZE + 1));
+
+            commands.apply(world);
+            REQUIRE(Tracked::alive == 1); // Last one won, the stale one was dropped.
+
+            commands.emplace_component<Tracked>(entity);
+            commands.clear();
+            REQUIRE(Tracked::alive == 1);
+
+            commands.emplace_component<Tracked>(entity); // Never applied.
+
+            // Moving hands the payloads over and leaves an empty, reusable buffer.
+            auto const created = commands.create_entity();
+            commands.emplace_component<Position>(created);
+
+            vecs::CommandBuffer moved { std::move(commands) };
+            REQUIRE(moved.size() == 3);
+            REQUIRE(commands.empty());
+
+            commands.emplace_component<Position>(commands.create_entity());
+            auto const count = world.entity_count();
+            commands.apply(world);
+            REQUIRE(world.entity_count() == count + 1);
+        }
+
+        REQUIRE(Tracked::alive == 1);
+    }
+
+    REQUIRE(Tracked::alive == 0);
+}
+
+TEST_CASE("ThreadCommandBuffers record without locks", "[command_buffer]") {
+    vecs::World world;
+    std::vector<vecs::Entity> entities{};
+
+    for (int i{}; i < 1000; ++i) {
+        entities.push_back(world.create_entity());
+    }
+
+    constexpr size_t THREAD_COUNT = 4;
+    vecs::ThreadCommandBuffers buffers { THREAD_COUNT };
+    std::vector<std::thread> threads{};
+
+    for (size_t t{}; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i { t }; i < entities.size(); i += THREAD_COUNT) {
+                buffers.local(t).add_component(entities[i], Position { static_cast<float>(t), 0.0f });
+            }
+
+            auto const spawned = buffers.local(t).create_entity();
+            buffers.local(t).add_component(spawned, Label { std::to_string(t) });
+        });
+    }
+
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    buffers.apply(world);
+
+    REQUIRE(world.entity_count() == 1000 + THREAD_COUNT);
+    REQUIRE(world.get_component<Position>(entities[6])->x == 2.0f);
+
+    // Applied in thread order.
+    REQUIRE(world.get_component<Label>(1000)->text == "0");
+    REQUIRE(world.get_component<Label>(1003)->text == "3");
+}
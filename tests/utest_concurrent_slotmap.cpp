@@ -0,0 +1,120 @@
+#include <catch2/catch_all.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+// std
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+
+// libs
+#include <vecs/data_structures/slotmap.hpp>
+#include <vecs/data_structures/concurrent_slotmap.hpp>
+
+namespace {
+
+constexpr size_t ITEM_COUNT = 1 << 16;
+
+template <typename F>
+void
+run_on_threads(size_t thread_count, F&& function) {
+    std::vector<std::thread> threads{};
+
+    for (size_t t{}; t < thread_count; ++t) {
+        threads.emplace_back(function, t);
+    }
+
+    for (auto& thread: threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+TEST_CASE("ConcurrentSlotMap recycles slots and rejects stale keys", "[slotmap][concurrent]") {
+    vecs::ConcurrentSlotMap<std::string> slotmap { 4 };
+
+    auto a = slotmap.push_back("a");
+    auto b = slotmap.push_back("b");
+    REQUIRE(slotmap.get(a) == "a");
+
+    REQUIRE(slotmap.erase(a));
+    REQUIRE_FALSE(slotmap.erase(a));
+    REQUIRE(slotmap.try_get(a) == nullptr);
+
+    auto c = slotmap.push_back("c");
+    REQUIRE(c.index() == a.index());
+    REQUIRE(*slotmap.try_get(c) == "c");
+    REQUIRE(slotmap.size() == 2);
+
+    [[maybe_unused]] auto d = slotmap.push_back("d");
+    [[maybe_unused]] auto e = slotmap.push_back("e");
+    REQUIRE_THROWS(slotmap.push_back("f"));
+
+    slotmap.clear();
+    REQUIRE_FALSE(slotmap.is_key_valid(b));
+    REQUIRE(slotmap.size() == 0);
+}
+
+TEST_CASE("ConcurrentSlotMap survives concurrent producers", "[slotmap][concurrent]") {
+    constexpr size_t thread_count = 8;
+    constexpr size_t per_thread = 4096;
+
+    // Room for the kept half plus what each thread may have in flight.
+    vecs::ConcurrentSlotMap<size_t> slotmap { thread_count * per_thread / 2 + thread_count * 2 };
+    std::vector<std::vector<vecs::ConcurrentSlotMap<size_t>::key_t>> kept(thread_count);
+
+    run_on_threads(thread_count, [&](size_t t) {
+        for (size_t i{}; i < per_thread; ++i) {
+            auto key = slotmap.push_back(t * per_thread + i);
+
+            // Keep half of them, so the freelist is hit from every thread.
+            if (i % 2 == 0) {
+                kept[t].push_back(key);
+            }
+            else {
+                slotmap.erase(key);
+            }
+        }
+    });
+
+    REQUIRE(slotmap.size() == thread_count * per_thread / 2);
+
+    for (size_t t{}; t < thread_count; ++t) {
+        for (size_t i{}; i < kept[t].size(); ++i) {
+            REQUIRE(slotmap.get(kept[t][i]) == t * per_thread + i * 2);
+        }
+    }
+}
+
+TEST_CASE("Benchmark ConcurrentSlotMap producers", "[!benchmark][slotmap][concurrent]") {
+    for (size_t thread_count: { 1, 4, 16, 64 }) {
+        auto const per_thread = ITEM_COUNT / thread_count;
+
+        BENCHMARK("mutex + PagedSlotMap, " + std::to_string(thread_count) + " threads") {
+            vecs::PagedSlotMap<size_t> slotmap;
+            std::mutex mutex;
+
+            run_on_threads(thread_count, [&](size_t) {
+                for (size_t i{}; i < per_thread; ++i) {
+                    std::scoped_lock lock { mutex };
+                    [[maybe_unused]] auto key = slotmap.push_back(i);
+                }
+            });
+
+            return slotmap.size();
+        };
+
+        BENCHMARK("ConcurrentSlotMap, " + std::to_string(thread_count) + " threads") {
+            vecs::ConcurrentSlotMap<size_t> slotmap { ITEM_COUNT };
+
+            run_on_threads(thread_count, [&](size_t) {
+                for (size_t i{}; i < per_thread; ++i) {
+                    [[maybe_unused]] auto key = slotmap.push_back(i);
+                }
+            });
+
+            return slotmap.size();
+        };
+    }
+}
@@ -0,0 +1,186 @@
+#include <catch2/catch_all.hpp>
+
+// std
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+#include <stdint.h>
+
+// libs
+#include <vecs/job_system.hpp>
+
+namespace {
+
+// Splits [begin, end) until small, every half is a job of 'group'.
+void
+sum_range(vecs::TaskGroup& group, std::vector<uint64_t> const& values, size_t begin, size_t end, std::atomic<uint64_t>& total) {
+    if (end - begin <= 1024) {
+        total += std::accumulate(values.begin() + begin, values.begin() + end, uint64_t{});
+        return;
+    }
+
+    auto const middle = begin + (end - begin) / 2;
+    group.run([&, begin, middle] { sum_range(group, values, begin, middle, total); });
+    sum_range(group, values, middle, end, total);
+}
+
+// Nested groups, waited for from inside jobs.
+uint64_t
+fibonacci(vecs::JobSystem& jobs, uint64_t n) {
+    if (n < 12) {
+        return n < 2 ? n : fibonacci(jobs, n - 1) + fibonacci(jobs, n - 2);
+    }
+
+    uint64_t a{};
+    vecs::TaskGroup group { jobs };
+    group.run([&] { a = fibonacci(jobs, n - 1); });
+    auto const b = fibonacci(jobs, n - 2);
+    group.wait();
+
+    return a + b;
+}
+
+} // namespace
+
+TEST_CASE("WorkStealingDeque pops LIFO and steals FIFO", "[job_system]") {
+    vecs::detail::WorkStealingDeque<int*> deque { 2 };
+    int items[100]{};
+
+    for (auto& item: items) {
+        deque.push(&item); // Grows several times.
+    }
+
+    REQUIRE(deque.pop() == &items[99]);
+    REQUIRE(deque.steal() == &items[0]);
+    REQUIRE(deque.steal() == &items[1]);
+
+    for (int i { 98 }; i >= 2; --i) {
+        REQUIRE(deque.pop() == &items[i]);
+    }
+
+    REQUIRE(deque.pop() == nullptr);
+    REQUIRE(deque.steal() == nullptr);
+    REQUIRE(deque.empty());
+}
+
+TEST_CASE("WorkStealingDeque hands every item out once under contention", "[job_system]") {
+    constexpr size_t COUNT = 200'000;
+    constexpr size_t THIEF_COUNT = 3;
+
+    vecs::detail::WorkStealingDeque<size_t*> deque{};
+    std::vector<size_t> items(COUNT);
+    std::vector<std::atomic<int>> taken(COUNT);
+    std::atomic<bool> done{};
+
+    auto const take = [&](size_t* item) { taken[static_cast<size_t>(item - items.data())].fetch_add(1); };
+
+    std::vector<std::thread> thieves{};
+    for (size_t t{}; t < THIEF_COUNT; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load() || !deque.empty()) {
+                if (auto* item = deque.steal()) {
+                    take(item);
+                }
+            }
+        });
+    }
+
+    for (size_t i{}; i < COUNT; ++i) {
+        deque.push(&items[i]);
+
+        if (i % 3 == 0) {
+            if (auto* item = deque.pop()) {
+                take(item);
+            }
+        }
+    }
+
+    while (auto* item = deque.pop()) {
+        take(item);
+    }
+
+    done = true;
+    for (auto& thief: thieves) {
+        thief.join();
+    }
+
+    REQUIRE(std::all_of(taken.begin(), taken.end(), [](auto const& count) { return count.load() == 1; }));
+}
+
+TEST_CASE("JobSystem runs task groups across workers", "[job_system]") {
+    vecs::JobSystem jobs { 4 };
+    REQUIRE(jobs.worker_count() == 4);
+    REQUIRE(jobs.worker_index() == vecs::JobSystem::NOT_A_WORKER);
+
+    std::vector<uint64_t> values(1'000'000);
+    std::iota(values.begin(), values.end(), uint64_t { 1 });
+
+    std::atomic<uint64_t> total{};
+    std::vector<std::atomic<int>> used(jobs.worker_count());
+
+    {
+        vecs::TaskGroup group { jobs };
+        group.run([&] { sum_range(group, values, 0, values.size(), total); });
+
+        for (int i{}; i < 64; ++i) {
+            group.run([&] {
+                auto const index = jobs.worker_index();
+                used[std::min(index, jobs.worker_count() - 1)] += index < jobs.worker_count() ? 1 : 1000;
+            });
+        }
+
+        group.wait();
+    }
+
+    REQUIRE(total == uint64_t { 1'000'000 } * 1'000'001 / 2);
+    REQUIRE(std::accumulate(used.begin(), used.end(), 0, [](int sum, auto const& n) { return sum + n.load(); }) == 64);
+    REQUIRE(fibonacci(jobs, 24) == 46'368);
+
+    // The group can be reused once waited for.
+    vecs::TaskGroup group { jobs };
+    std::atomic<int> count{};
+    for (int round{}; round < 3; ++round) {
+        for (int i{}; i < 100; ++i) {
+            group.run([&] { ++count; });
+        }
+
+        group.wait();
+        REQUIRE(count == (round + 1) * 100);
+    }
+}
+
+TEST_CASE("TaskGroup rethrows the first job error", "[job_system]") {
+    vecs::JobSystem jobs { 2 };
+    vecs::TaskGroup group { jobs };
+    std::atomic<int> finished{};
+
+    for (int i{}; i < 10; ++i) {
+        group.run([&, i] {
+            if (i == 5) {
+                throw std::runtime_error("job failed");
+            }
+
+            ++finished;
+        });
+    }
+
+    REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+    REQUIRE(finished == 9);
+
+    // A job that fails to be created is not counted, waiting does not hang.
+    struct Uncopyable {
+        Uncopyable() = default;
+        Uncopyable(Uncopyable const&) { throw std::runtime_error("copy failed"); }
+        void operator()() const {}
+    } const uncopyable{};
+
+    REQUIRE_THROWS_AS(group.run(uncopyable), std::runtime_error);
+    REQUIRE_NOTHROW(group.wait());
+
+    group.run([&] { ++finished; });
+    REQUIRE_NOTHROW(group.wait());
+    REQUIRE(finished == 10);
+}
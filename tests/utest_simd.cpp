@@ -0,0 +1,161 @@
+#include <catch2/catch_all.hpp>
+
+// std
+#include <array>
+#include <vector>
+#include <cmath>
+#include <span>
+#include <stdint.h>
+
+// libs
+#include <vecs/simd.hpp>
+#include <vecs/entities.hpp>
+
+namespace {
+
+struct Position {
+    float x{}, y{}, z{};
+};
+
+struct Velocity {
+    float x{}, y{}, z{};
+};
+
+// Odd count, so every level runs full registers and a tail.
+constexpr size_t COUNT = 37;
+
+std::vector<float>
+ramp(float first, float step) {
+    std::vector<float> values(COUNT);
+    for (size_t i{}; i < COUNT; ++i) {
+        values[i] = first + step * static_cast<float>(i);
+    }
+
+    return values;
+}
+
+// Every level this CPU supports, then back to the best one.
+template <typename F>
+void
+at_every_level(F&& test) {
+    for (auto const level: { vecs::simd::Level::Scalar, vecs::simd::Level::SSE42, vecs::simd::Level::AVX2 }) {
+        if (vecs::simd::set_level(level) == level) {
+            test();
+        }
+    }
+
+    vecs::simd::set_level(vecs::simd::Level::AVX2);
+}
+
+} // namespace
+
+VECS_SOA_FIELDS(Position, x, y, z);
+VECS_SOA_FIELDS(Velocity, x, y, z);
+
+TEST_CASE("SIMD kernels match the scalar math at every level", "[simd]") {
+    REQUIRE(vecs::simd::level() == vecs::simd::supported_level());
+
+    at_every_level([] {
+        auto x = ramp(0.0f, 1.0f);
+        auto const v = ramp(1.0f, 0.5f);
+
+        vecs::simd::integrate(x, v, 0.5f);
+        for (size_t i{}; i < COUNT; ++i) {
+            REQUIRE(x[i] == Catch::Approx(static_cast<float>(i) + v[i] * 0.5f));
+        }
+
+        auto const cx = ramp(0.0f, 1.0f), cy = ramp(1.0f, 1.0f), cz = ramp(2.0f, 1.0f);
+        auto const ex = ramp(0.5f, 0.0f), ey = ramp(1.0f, 0.0f), ez = ramp(0.0f, 0.25f);
+        std::vector<float> min_x(COUNT), min_y(COUNT), min_z(COUNT), max_x(COUNT), max_y(COUNT), max_z(COUNT);
+
+        vecs::simd::update_aabbs({ cx, cy, cz }, { ex, ey, ez }, { min_x, min_y, min_z }, { max_x, max_y, max_z });
+        for (size_t i{}; i < COUNT; ++i) {
+            REQUIRE(min_x[i] == cx[i] - 0.5f);
+            REQUIRE(max_y[i] == cy[i] + 1.0f);
+            REQUIRE(max_z[i] - min_z[i] == Catch::Approx(2.0f * ez[i]));
+        }
+
+        auto qx = ramp(1.0f, 0.0f), qy = ramp(2.0f, 1.0f), qz = ramp(-3.0f, 0.5f), qw = ramp(4.0f, 0.0f);
+        qx[5] = qy[5] = qz[5] = qw[5] = 0.0f;
+
+        vecs::simd::normalize({ qx, qy, qz, qw });
+        for (size_t i{}; i < COUNT; ++i) {
+            auto const length = std::sqrt(qx[i] * qx[i] + qy[i] * qy[i] + qz[i] * qz[i] + qw[i] * qw[i]);
+            REQUIRE(length == Catch::Approx(i == 5 ? 0.0f : 1.0f));
+        }
+
+        std::vector<uint8_t> visible(COUNT);
+        auto const visible_count = vecs::simd::cull_distance({ cx, cy, cz }, { 0.0f, 1.0f, 2.0f }, 10.0f, visible);
+
+        size_t expected{};
+        for (size_t i{}; i < COUNT; ++i) {
+            auto const near = std::sqrt(3.0f) * static_cast<float>(i) <= 10.0f;
+            REQUIRE(visible[i] == (near ? 1 : 0));
+            expected += near ? 1 : 0;
+        }
+
+        REQUIRE(visible_count == expected);
+    });
+}
+
+TEST_CASE("SIMD compose builds TRS matrices", "[simd]") {
+    at_every_level([] {
+        // 90 degrees around z, then scaled and moved.
+        auto const half = std::sqrt(0.5f);
+        auto const tx = ramp(1.0f, 1.0f), ty = ramp(2.0f, 0.0f), tz = ramp(3.0f, 0.0f);
+        auto const qx = ramp(0.0f, 0.0f), qy = ramp(0.0f, 0.0f), qz = ramp(half, 0.0f), qw = ramp(half, 0.0f);
+        auto const sx = ramp(2.0f, 0.0f), sy = ramp(3.0f, 0.0f), sz = ramp(4.0f, 0.0f);
+
+        std::array<std::vector<float>, 16> m{};
+        vecs::simd::Mat4Span matrix{};
+        for (size_t e{}; e < 16; ++e) {
+            m[e].resize(COUNT);
+            matrix.m[e] = m[e];
+        }
+
+        vecs::simd::compose({ tx, ty, tz }, { qx, qy, qz, qw }, { sx, sy, sz }, matrix);
+
+        // Column-major: x axis -> y * 2, y axis -> -x * 3, z axis -> z * 4.
+        std::array const expected { 0.0f, 2.0f, 0.0f, 0.0f, -3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 4.0f, 0.0f, 0.0f, 2.0f, 3.0f, 1.0f };
+
+        for (size_t i{}; i < COUNT; ++i) {
+            for (size_t e{}; e < 16; ++e) {
+                auto const want = e == 12 ? tx[i] : expected[e];
+                REQUIRE(m[e][i] == Catch::Approx(want).margin(1e-6));
+            }
+        }
+    });
+}
+
+TEST_CASE("SIMD kernels run over split component chunks", "[simd][world]") {
+    vecs::World world;
+    constexpr vecs::EntityId ENTITIES = 5'000;
+
+    for (vecs::EntityId e{}; e < ENTITIES; ++e) {
+        world.add_component(e, Position { static_cast<float>(e), 0.0f, 0.0f });
+        world.add_component(e, Velocity { 1.0f, 2.0f, -1.0f });
+    }
+
+    world.view<Position, Velocity const>().each_chunk([](auto position, auto velocity) {
+        vecs::simd::integrate(position, velocity, 0.5f);
+    });
+
+    REQUIRE(world.get_component<Position>(1234)->x == 1234.5f);
+    REQUIRE(world.get_component<Position>(1234)->y == 1.0f);
+    REQUIRE(world.get_component<Position>(1234)->z == -0.5f);
+}
+
+TEST_CASE("Benchmark scalar against dispatched integrate", "[!benchmark][simd]") {
+    std::vector<float> x(1'000'000, 0.0f);
+    std::vector<float> const v(1'000'000, 1.0f);
+
+    vecs::simd::set_level(vecs::simd::Level::Scalar);
+    BENCHMARK("integrate scalar, 1M floats") {
+        vecs::simd::integrate(x, v, 0.016f);
+    };
+
+    vecs::simd::set_level(vecs::simd::Level::AVX2);
+    BENCHMARK("integrate dispatched, 1M floats") {
+        vecs::simd::integrate(x, v, 0.016f);
+    };
+}
@@ -0,0 +1,660 @@
+#include <catch2/catch_all.hpp>
+
+// std
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <string>
+
+// libs
+#include <vecs/data_structures/slotmap.hpp>
+
+TEST_CASE("PagedSlotMap grows page by page", "[slotmap]") {
+    vecs::PagedSlotMap<int, 4> slotmap;
+    std::vector<vecs::PagedSlotMap<int, 4>::key_t> keys;
+
+    REQUIRE(slotmap.capacity() == 0);
+
+    for (int i{}; i < 10; ++i) {
+        keys.push_back(slotmap.push_back(i));
+    }
+
+    REQUIRE(slotmap.size() == 10);
+    REQUIRE(slotmap.capacity() == 12);
+
+    for (auto key: keys) {
+        REQUIRE(slotmap.is_key_valid(key));
+    }
+}
+
+TEST_CASE("PagedSlotMap keeps element addresses while growing", "[slotmap]") {
+    vecs::PagedSlotMap<int, 4> slotmap;
+    auto first_key = slotmap.push_back(42);
+    auto first_it = slotmap.begin();
+    int* first = &*first_it;
+
+    for (int i{}; i < 100; ++i) {
+        [[maybe_unused]] auto key = slotmap.push_back(i);
+    }
+
+    REQUIRE(first == &*slotmap.begin());
+    REQUIRE(first_it == slotmap.begin());
+    REQUIRE(*first == 42);
+    REQUIRE(first_it[100] == 99);
+    REQUIRE(slotmap.is_key_valid(first_key));
+}
+
+TEST_CASE("PagedSlotMap releases unused pages", "[slotmap]") {
+    vecs::PagedSlotMap<int, 4> slotmap;
+    std::vector<vecs::PagedSlotMap<int, 4>::key_t> keys;
+
+    for (int i{}; i < 32; ++i) {
+        keys.push_back(slotmap.push_back(i));
+    }
+
+    for (auto key: keys) {
+        REQUIRE(slotmap.erase(key));
+    }
+
+    REQUIRE(slotmap.size() == 0);
+
+    slotmap.shrink_to_fit();
+    auto key = slotmap.push_back(7);
+
+    REQUIRE(slotmap.is_key_valid(key));
+    REQUIRE(*slotmap.begin() == 7);
+
+    int sum{};
+    for (int value: slotmap) {
+        sum += value;
+    }
+
+    REQUIRE(sum == 7);
+}
+
+TEST_CASE("SlotMap throws when full", "[slotmap]") {
+    vecs::SlotMap<int, 2> slotmap;
+
+    [[maybe_unused]] auto a = slotmap.push_back(1);
+    [[maybe_unused]] auto b = slotmap.push_back(2);
+
+    REQUIRE_THROWS(slotmap.push_back(3));
+}
+
+TEST_CASE("MultiSlotMap moves every column in lockstep", "[slotmap]") {
+    struct Position { float x, y; };
+    struct Health { int value; };
+
+    vecs::MultiSlotMap<Position, Health> slotmap;
+
+    auto a = slotmap.push_back(Position { 1, 1 }, Health { 10 });
+    auto b = slotmap.push_back(Position { 2, 2 }, Health { 20 });
+    auto c = slotmap.push_back(Position { 3, 3 }, Health { 30 });
+
+    REQUIRE(slotmap.erase(a));
+    REQUIRE(slotmap.size() == 2);
+    REQUIRE(slotmap.is_key_valid(b));
+    REQUIRE(slotmap.is_key_valid(c));
+
+    // Last element (c) was moved into the hole left by a, in both columns.
+    float x_sum{};
+    int health_sum{};
+    slotmap.each<Position, Health>([&](Position& position, Health& health) {
+        REQUIRE(position.x * 10 == health.value);
+        x_sum += position.x;
+        health_sum += health.value;
+    });
+
+    REQUIRE(x_sum == 5);
+    REQUIRE(health_sum == 50);
+
+    int only_health{};
+    for (auto const& health: slotmap.column<Health>()) {
+        only_health += health.value;
+    }
+
+    REQUIRE(only_health == 50);
+}
+
+TEST_CASE("SlotMap hands out contiguous column spans", "[slotmap]") {
+    struct Position { float x, y; };
+    struct Velocity { float dx, dy; };
+
+    vecs::BasicSlotMap<vecs::SlotMapPolicy<vecs::PagedStorage<4>>, Position, Velocity> slotmap;
+
+    for (int i{}; i < 10; ++i) {
+        [[maybe_unused]] auto key = slotmap.push_back(Position { static_cast<float>(i), 0 }, Velocity { 1, 2 });
+    }
+
+    size_t runs{};
+    size_t count{};
+    slotmap.each_chunk<Position, Velocity const>([&](std::span<Position> positions, std::span<Velocity const> velocities) {
+        REQUIRE(positions.size() == velocities.size());
+
+        for (size_t i{}; i < positions.size(); ++i) {
+            positions[i].x += velocities[i].dx;
+            positions[i].y += velocities[i].dy;
+        }
+
+        ++runs;
+        count += positions.size();
+    });
+
+    // One run per page.
+    REQUIRE(runs == 3);
+    REQUIRE(count == 10);
+
+    float x_sum{};
+    slotmap.each<Position>([&](Position const& position) {
+        REQUIRE(position.y == 2);
+        x_sum += position.x;
+    });
+
+    REQUIRE(x_sum == 55);
+}
+
+TEST_CASE("SlotMap reads elements back by key", "[slotmap]") {
+    vecs::PagedSlotMap<int, 8> slotmap;
+    std::vector<vecs::PagedSlotMap<int, 8>::key_t> keys;
+
+    for (int i{}; i < 100; ++i) {
+        keys.push_back(slotmap.push_back(i));
+    }
+
+    REQUIRE(slotmap.get(keys[42]) == 42);
+    REQUIRE(slotmap.erase(keys[42]));
+    REQUIRE(slotmap.try_get(keys[42]) == nullptr);
+    REQUIRE(*slotmap.try_get(keys[99]) == 99);
+
+    std::vector<int*> out(keys.size());
+    auto valid = slotmap.gather(std::span { keys }, std::span { out });
+
+    REQUIRE(valid == 99);
+    REQUIRE(out[42] == nullptr);
+
+    for (int i{}; i < 100; ++i) {
+        if (i != 42) {
+            REQUIRE(*out[i] == i);
+        }
+    }
+}
+
+TEST_CASE("PackedKey fits index and generation in one word", "[slotmap]") {
+    using Key32 = vecs::PackedKey<uint32_t, 20>;
+    using Key64 = vecs::PackedKey<uint64_t, 32>;
+
+    STATIC_REQUIRE(sizeof(Key32::type) == 4);
+    STATIC_REQUIRE(sizeof(Key64::type) == 8);
+    STATIC_REQUIRE(sizeof(vecs::SlotMap<int, 4>::key_t) == 16);
+
+    auto key = Key32::make(12345, 77);
+    REQUIRE(key.index() == 12345);
+    REQUIRE(key.generation() == 77);
+}
+
+TEST_CASE("SlotMap detects stale keys with per-slot generations", "[slotmap]") {
+    vecs::PagedSlotMap<int, 4, vecs::PackedKey<uint32_t, 30>> slotmap;
+
+    // A default key never points to a live slot.
+    REQUIRE_FALSE(slotmap.is_key_valid({}));
+
+    // Two generation bits: the slot wraps around after two uses.
+    auto first = slotmap.push_back(1);
+    REQUIRE(slotmap.erase(first));
+
+    auto second = slotmap.push_back(2);
+    REQUIRE(second.index() == first.index());
+    REQUIRE_FALSE(slotmap.is_key_valid(first));
+    REQUIRE(slotmap.get(second) == 2);
+
+    slotmap.clear();
+    REQUIRE_FALSE(slotmap.is_key_valid(second));
+}
+
+TEST_CASE("SlotMap rejects keys into free slots", "[slotmap]") {
+    using slotmap_t = vecs::SlotMap<std::string, 8>;
+    using policy_t = slotmap_t::key_policy_t;
+
+    slotmap_t slotmap;
+
+    // Fresh slots start at generation 0, same as a default key.
+    REQUIRE_FALSE(slotmap.is_key_valid({}));
+    REQUIRE(slotmap.try_get(slotmap_t::key_t {}) == nullptr);
+    REQUIRE_FALSE(slotmap.erase({}));
+
+    // Slots past the ones handed out so far were never used.
+    auto const key = slotmap.push_back("live");
+    auto const unused = policy_t::make(policy_t::index(key) + 3, 0);
+    REQUIRE_FALSE(slotmap.is_key_valid(unused));
+    REQUIRE_FALSE(slotmap.erase(unused));
+
+    // Neither are the even generations of released slots.
+    REQUIRE(slotmap.erase(key));
+    REQUIRE_FALSE(slotmap.is_key_valid(policy_t::make(policy_t::index(key), policy_t::generation(key) + 1)));
+    REQUIRE(slotmap.size() == 0);
+}
+
+namespace {
+
+// Not default constructible and counts live instances.
+struct Tracked {
+    static inline int alive {};
+    int value;
+
+    explicit Tracked(int v) : value(v) { ++alive; }
+    Tracked(Tracked const& other) : value(other.value) { ++alive; }
+    Tracked(Tracked&& other) noexcept : value(other.value) { ++alive; }
+    ~Tracked() { --alive; }
+};
+
+} // namespace
+
+TEST_CASE("SlotMap constructs and destroys elements in place", "[slotmap]") {
+    {
+        vecs::SlotMap<Tracked, 8> slotmap;
+        REQUIRE(Tracked::alive == 0);
+
+        auto a = slotmap.emplace_back(1);
+        auto b = slotmap.emplace_back(2);
+        [[maybe_unused]] auto c = slotmap.emplace_back(3);
+        REQUIRE(Tracked::alive == 3);
+
+        REQUIRE(slotmap.erase(a));
+        REQUIRE(Tracked::alive == 2);
+        REQUIRE(slotmap.get(b).value == 2);
+
+        auto copy { slotmap };
+        REQUIRE(Tracked::alive == 4);
+        REQUIRE(copy.get(b).value == 2);
+
+        auto moved { std::move(copy) };
+        REQUIRE(Tracked::alive == 4);
+        REQUIRE(copy.size() == 0);
+        REQUIRE(moved.get(b).value == 2);
+
+        slotmap.clear();
+        REQUIRE(Tracked::alive == 2);
+    }
+
+    REQUIRE(Tracked::alive == 0);
+
+    {
+        vecs::PagedSlotMap<Tracked, 4> slotmap;
+
+        for (int i{}; i < 10; ++i) {
+            [[maybe_unused]] auto key = slotmap.emplace_back(i);
+        }
+
+        auto moved { std::move(slotmap) };
+        REQUIRE(Tracked::alive == 10);
+        REQUIRE(moved.size() == 10);
+    }
+
+    REQUIRE(Tracked::alive == 0);
+}
+
+TEST_CASE("SlotMap inserts and erases in bulk", "[slotmap]") {
+    using SlotMap = vecs::PagedSlotMap<int, 16>;
+
+    SlotMap slotmap;
+    std::vector<int> values(100);
+    std::vector<SlotMap::key_t> keys(values.size());
+
+    for (int i{}; i < 100; ++i) {
+        values[i] = i;
+    }
+
+    slotmap.push_back_range(keys, std::span<int const> { values });
+    REQUIRE(slotmap.size() == 100);
+
+    for (int i{}; i < 100; ++i) {
+        REQUIRE(slotmap.get(keys[i]) == i);
+    }
+
+    // Erase every even element, plus one repeated and one stale key.
+    std::vector<SlotMap::key_t> doomed{};
+    for (int i{}; i < 100; i += 2) {
+        doomed.push_back(keys[i]);
+    }
+    doomed.push_back(keys[0]);
+    doomed.push_back({});
+
+    REQUIRE(slotmap.erase_batch(doomed) == 50);
+    REQUIRE(slotmap.size() == 50);
+
+    for (int i{}; i < 100; ++i) {
+        REQUIRE(slotmap.is_key_valid(keys[i]) == (i % 2 == 1));
+
+        if (i % 2 == 1) {
+            REQUIRE(slotmap.get(keys[i]) == i);
+        }
+    }
+
+    REQUIRE(slotmap.erase_if([](int value) { return value > 50; }) == 25);
+    REQUIRE(slotmap.size() == 25);
+
+    for (int value: slotmap) {
+        REQUIRE(value % 2 == 1);
+        REQUIRE(value <= 50);
+    }
+
+    std::vector<SlotMap::key_t> more(10);
+    slotmap.emplace_n(more, 7);
+    REQUIRE(slotmap.size() == 35);
+    REQUIRE(slotmap.get(more[9]) == 7);
+}
+
+TEST_CASE("MultiSlotMap bulk insert fills every column", "[slotmap]") {
+    vecs::MultiSlotMap<int, float> slotmap;
+    std::vector<int> ints { 1, 2, 3 };
+    std::vector<float> floats { 0.5f, 1.5f, 2.5f };
+    std::vector<vecs::MultiSlotMap<int, float>::key_t> keys(3);
+
+    slotmap.push_back_range(keys, std::span<int const> { ints }, std::span<float const> { floats });
+
+    REQUIRE(slotmap.get<int>(keys[1]) == 2);
+    REQUIRE(slotmap.get<float>(keys[2]) == 2.5f);
+    REQUIRE(slotmap.erase_if([](int i, float) { return i == 1; }) == 1);
+    REQUIRE(slotmap.get<float>(keys[2]) == 2.5f);
+}
+
+TEST_CASE("StableSlotMap keeps insertion order across erases", "[slotmap]") {
+    using SlotMap = vecs::StableSlotMap<int, 64>;
+
+    SlotMap slotmap;
+    std::vector<SlotMap::key_t> keys {};
+
+    for (int i{}; i < 200; ++i) {
+        keys.push_back(slotmap.push_back(i));
+    }
+
+    // Few holes: stay in place and get skipped.
+    REQUIRE(slotmap.erase(keys[0]));
+    REQUIRE(slotmap.erase(keys[70]));
+    REQUIRE(slotmap.erase(keys[71]));
+    REQUIRE(slotmap.size() == 197);
+
+    std::vector<int> seen {};
+    for (int value: slotmap) {
+        seen.push_back(value);
+    }
+
+    REQUIRE(seen.size() == 197);
+    REQUIRE(std::is_sorted(seen.begin(), seen.end()));
+    REQUIRE(seen.front() == 1);
+    REQUIRE(std::find(seen.begin(), seen.end(), 70) == seen.end());
+
+    // Trailing holes shrink the dense range, new elements go last.
+    REQUIRE(slotmap.erase(keys[199]));
+    keys[199] = slotmap.push_back(1000);
+
+    seen.clear();
+    slotmap.each<int>([&](int value) { seen.push_back(value); });
+    REQUIRE(seen.back() == 1000);
+    REQUIRE(std::is_sorted(seen.begin(), seen.end() - 1));
+
+    // Erasing every other element passes the hole threshold and compacts.
+    std::vector<SlotMap::key_t> doomed {};
+    for (int i { 1 }; i < 199; i += 2) {
+        doomed.push_back(keys[i]);
+    }
+
+    REQUIRE(slotmap.erase_batch(doomed) == 98); // 71 was gone already.
+    REQUIRE(slotmap.size() == 99);
+
+    seen.clear();
+    for (int value: slotmap.column<int>()) {
+        seen.push_back(value);
+    }
+
+    REQUIRE(seen.size() == 99);
+    REQUIRE(std::is_sorted(seen.begin(), seen.end()));
+
+    for (int i { 2 }; i < 199; i += 2) {
+        if (i == 70) {
+            continue;
+        }
+
+        REQUIRE(slotmap.get(keys[i]) == i);
+    }
+
+    REQUIRE(slotmap.erase_if([](int value) { return value < 100; }) == 48);
+    REQUIRE(slotmap.size() == 51);
+    REQUIRE(*slotmap.begin() == 100);
+    REQUIRE(slotmap.get(keys[199]) == 1000);
+
+    SlotMap copy { slotmap };
+    REQUIRE(copy.size() == 51);
+    REQUIRE(copy.get(keys[150]) == 150);
+
+    // Bulk inserts grow the live bitset before constructing anything.
+    std::vector<SlotMap::key_t> more(300);
+    slotmap.emplace_n(more, 7);
+    REQUIRE(slotmap.size() == 351);
+    REQUIRE(slotmap.get(more.back()) == 7);
+    REQUIRE(std::count(slotmap.begin(), slotmap.end(), 7) == 300);
+}
+
+TEST_CASE("StableSlotMap iterators survive inserts that grow the live bitset", "[slotmap]") {
+    vecs::StableSlotMap<int, 64> slotmap;
+    std::vector<vecs::StableSlotMap<int, 64>::key_t> keys {};
+
+    for (int i{}; i < 10; ++i) {
+        keys.push_back(slotmap.push_back(i));
+    }
+
+    REQUIRE(slotmap.erase(keys[1]));
+
+    auto it = slotmap.begin();
+    REQUIRE(*++it == 2);
+
+    // Past several 64 position words, the bitset reallocates.
+    for (int i { 10 }; i < 310; ++i) {
+        keys.push_back(slotmap.push_back(i));
+    }
+
+    std::vector<int> seen {};
+    for (; it != slotmap.end(); ++it) {
+        seen.push_back(*it);
+    }
+
+    REQUIRE(seen.size() == 308);
+    REQUIRE(seen.front() == 2);
+    REQUIRE(seen.back() == 309);
+}
+
+TEST_CASE("SlotMap sorts and reorders without breaking keys", "[slotmap]") {
+    using SlotMap = vecs::PagedSlotMap<Tracked, 16>;
+
+    SlotMap slotmap;
+    std::vector<SlotMap::key_t> keys {};
+
+    for (int i{}; i < 100; ++i) {
+        keys.push_back(slotmap.push_back(Tracked { (i * 37) % 100 }));
+    }
+
+    auto const by_value = [](Tracked const& a, Tracked const& b) { return a.value < b.value; };
+
+    slotmap.sort(by_value);
+    REQUIRE(std::is_sorted(slotmap.begin(), slotmap.end(), by_value));
+
+    for (int i{}; i < 100; ++i) {
+        REQUIRE(slotmap.get(keys[i]).value == (i * 37) % 100);
+    }
+
+    // Reversing is a permutation made of 2-cycles.
+    std::vector<SlotMap::index_t> reverse(100);
+    for (size_t i{}; i < reverse.size(); ++i) {
+        reverse[i] = static_cast<SlotMap::index_t>(99 - i);
+    }
+
+    slotmap.reorder(reverse);
+    REQUIRE(slotmap.begin()->value == 99);
+    REQUIRE(slotmap.get(keys[1]).value == 37);
+    REQUIRE_THROWS_AS(slotmap.reorder(std::span { reverse }.first(10)), std::invalid_argument);
+
+    // Incremental sort gets there in bounded steps, n log n comparisons in total.
+    size_t calls{};
+    size_t compares{};
+    size_t total{};
+    auto const counted = [&](Tracked const& a, Tracked const& b) { ++compares; return a.value < b.value; };
+
+    for (bool sorted {}; !sorted; ++calls) {
+        compares = 0;
+        sorted = slotmap.sort_step(counted, 64);
+
+        REQUIRE(compares <= 64);
+        total += compares;
+    }
+
+    REQUIRE(calls > 1);
+    REQUIRE(total <= 100 * 7);
+    REQUIRE(std::is_sorted(slotmap.begin(), slotmap.end(), by_value));
+
+    // Changes in between drop erased elements and leave new ones last, even when the erased slot is reused.
+    REQUIRE_FALSE(slotmap.sort_step(by_value, 200));
+    auto const middle = slotmap.get(keys[50]).value;
+    slotmap.erase(keys[50]);
+    auto const replaced = slotmap.push_back(Tracked { 1000 });
+    REQUIRE(SlotMap::key_policy_t::index(replaced) == SlotMap::key_policy_t::index(keys[50]));
+
+    while (!slotmap.sort_step(by_value, 200)) {}
+    REQUIRE(std::is_sorted(slotmap.begin(), slotmap.end(), by_value));
+    REQUIRE(slotmap.get(replaced).value == 1000);
+    slotmap.erase(replaced);
+    keys[50] = slotmap.push_back(Tracked { middle });
+    slotmap.sort(by_value);
+
+    REQUIRE_FALSE(slotmap.sort_step(by_value, 200));
+    slotmap.erase(keys[0]);
+    auto const added = slotmap.push_back(Tracked { -1 });
+
+    while (!slotmap.sort_step(by_value, 200)) {}
+    REQUIRE(std::is_sorted(std::next(slotmap.begin()), std::prev(slotmap.end()), by_value));
+    REQUIRE(slotmap.get(added).value == -1);
+    REQUIRE(std::prev(slotmap.end())->value == -1);
+    slotmap.erase(added);
+    keys[0] = slotmap.push_back(Tracked { 0 });
+    slotmap.sort(by_value);
+
+    for (int i{}; i < 100; ++i) {
+        REQUIRE(slotmap.get(keys[i]).value == (i * 37) % 100);
+    }
+
+    slotmap.clear();
+    REQUIRE(Tracked::alive == 0);
+}
+
+TEST_CASE("SlotMap sort_step finishes while the map churns", "[slotmap]") {
+    constexpr int COUNT = 2000;
+    constexpr size_t BUDGET = 400;
+
+    vecs::PagedSlotMap<int> slotmap;
+    vecs::StableSlotMap<int> stable;
+    std::vector<vecs::PagedSlotMap<int>::key_t> keys {};
+    std::vector<vecs::StableSlotMap<int>::key_t> stable_keys {};
+
+    for (int i{}; i < COUNT; ++i) {
+        keys.push_back(slotmap.push_back((i * 7919) % COUNT));
+        stable_keys.push_back(stable.push_back((i * 7919) % COUNT));
+    }
+
+    auto const less = [](int a, int b) { return a < b; };
+
+    // One erase and one insert per frame, a sort without churn needs about 2 * 11 * COUNT / BUDGET frames.
+    int frames{};
+    for (bool sorted {}; !sorted; ++frames) {
+        REQUIRE(frames < 100);
+        sorted = slotmap.sort_step(less, BUDGET);
+
+        auto const victim = static_cast<size_t>(frames * 613) % keys.size();
+        REQUIRE(slotmap.erase(keys[victim]));
+        keys[victim] = slotmap.push_back(COUNT + frames);
+    }
+
+    for (auto const key: keys) {
+        REQUIRE(slotmap.is_key_valid(key));
+    }
+
+    while (!slotmap.sort_step(less, BUDGET)) {}
+    REQUIRE(std::is_sorted(slotmap.begin(), slotmap.end()));
+
+    // Stable order keeps the sorted part sorted through erases, new elements follow it.
+    frames = 0;
+    for (bool sorted {}; !sorted; ++frames) {
+        REQUIRE(frames < 100);
+        sorted = stable.sort_step(less, BUDGET);
+
+        if (!sorted) {
+            auto const victim = static_cast<size_t>(frames * 613) % stable_keys.size();
+            REQUIRE(stable.erase(stable_keys[victim]));
+            stable_keys[victim] = stable.push_back(-1 - frames);
+        }
+    }
+
+    std::vector<int> values(stable.begin(), stable.end());
+    auto const old_end = std::find_if(values.begin(), values.end(), [](int v) { return v < 0; });
+
+    REQUIRE(std::is_sorted(values.begin(), old_end));
+    REQUIRE(std::all_of(old_end, values.end(), [](int v) { return v < 0; }));
+    REQUIRE(values.size() == COUNT);
+}
+
+TEST_CASE("MultiSlotMap and StableSlotMap sort by a column", "[slotmap]") {
+    vecs::MultiSlotMap<int, float> multi;
+    auto const a = multi.push_back(3, 0.3f);
+    auto const b = multi.push_back(1, 0.1f);
+    auto const c = multi.push_back(2, 0.2f);
+
+    multi.sort<int>([](int x, int y) { return x < y; });
+
+    std::vector<float> floats {};
+    multi.each<float>([&](float f) { floats.push_back(f); });
+    REQUIRE(floats == std::vector { 0.1f, 0.2f, 0.3f });
+    REQUIRE(multi.get<float>(a) == 0.3f);
+    REQUIRE(multi.get<int>(b) == 1);
+    REQUIRE(multi.get<int>(c) == 2);
+
+    vecs::StableSlotMap<int> stable;
+    std::vector<vecs::StableSlotMap<int>::key_t> keys {};
+    for (int i{}; i < 10; ++i) {
+        keys.push_back(stable.push_back(9 - i));
+    }
+
+    REQUIRE(stable.erase(keys[3])); // Leaves a hole.
+    stable.sort([](int x, int y) { return x < y; });
+
+    REQUIRE(std::is_sorted(stable.begin(), stable.end()));
+    REQUIRE(stable.size() == 9);
+    REQUIRE(stable.get(keys[0]) == 9);
+    REQUIRE(stable.get(keys[9]) == 0);
+}
+
+TEST_CASE("SlotMap layout policies place hot members and arrays", "[slotmap]") {
+    using DebugMap   = vecs::BasicSlotMap<vecs::SlotMapPolicy<vecs::PagedStorage<64>, uint32_t, vecs::SwapOrder, vecs::DebugLayout>, int>;
+    using ReleaseMap = vecs::BasicSlotMap<vecs::SlotMapPolicy<vecs::PagedStorage<64>, uint32_t, vecs::SwapOrder, vecs::ReleaseLayout>, int>;
+    using FixedMap   = vecs::BasicSlotMap<vecs::SlotMapPolicy<vecs::FixedStorage<32>, uint32_t, vecs::SwapOrder, vecs::ReleaseLayout>, int>;
+
+    constexpr auto debug = DebugMap::layout_report();
+    constexpr auto release = ReleaseMap::layout_report();
+    constexpr auto fixed = FixedMap::layout_report();
+
+    STATIC_REQUIRE(debug.tag_bytes == 64);
+    STATIC_REQUIRE(!debug.hot_is_packed());
+    STATIC_REQUIRE(release.tag_bytes == 0);
+    STATIC_REQUIRE(release.hot_is_packed());
+    STATIC_REQUIRE(release.hot_in_one_line());
+    STATIC_REQUIRE(release.object_size < debug.object_size);
+    STATIC_REQUIRE(fixed.hot_in_one_line());
+    STATIC_REQUIRE(fixed.array_alignment == vecs::CACHE_LINE_SIZE);
+
+    auto release_map = std::make_unique<ReleaseMap>();
+    auto fixed_map = std::make_unique<FixedMap>();
+    (void)release_map->push_back(1);
+    (void)fixed_map->push_back(1);
+
+    REQUIRE(reinterpret_cast<uintptr_t>(release_map.get()) % vecs::CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(&*release_map->begin()) % vecs::CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(&*fixed_map->begin()) % vecs::CACHE_LINE_SIZE == 0);
+}
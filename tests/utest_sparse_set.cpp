@@ -0,0 +1,55 @@
+#include <catch2/catch_all.hpp>
+
+// std
+#include <string>
+
+// libs
+#include <vecs/data_structures/sparse_set.hpp>
+
+TEST_CASE("SparseSet inserts, erases and stays packed", "[sparse_set]") {
+    vecs::SparseSet<std::string> set;
+
+    set.emplace(3, "three");
+    set.emplace(1'000'000, "million");
+    set.emplace(7, "seven");
+
+    REQUIRE(set.size() == 3);
+    REQUIRE(set.contains(1'000'000));
+    REQUIRE_FALSE(set.contains(4));
+    REQUIRE_FALSE(set.contains(50'000'000)); // Page never allocated.
+    REQUIRE(set.get(7) == "seven");
+    REQUIRE(set.try_get(8) == nullptr);
+
+    set.emplace(3, "THREE"); // Assigns in place.
+    REQUIRE(set.size() == 3);
+    REQUIRE(set.get(3) == "THREE");
+
+    // The last element fills the hole.
+    REQUIRE(set.erase(3));
+    REQUIRE_FALSE(set.erase(3));
+    REQUIRE(set.size() == 2);
+    REQUIRE(set.entities()[0] == 7);
+    REQUIRE(set.values()[0] == "seven");
+    REQUIRE(set.get(1'000'000) == "million");
+
+    set.clear();
+    REQUIRE(set.empty());
+    REQUIRE_FALSE(set.contains(7));
+}
+
+TEST_CASE("SparseSet stores no values for tags", "[sparse_set]") {
+    struct Tag {};
+
+    STATIC_REQUIRE(!vecs::SparseSet<Tag>::STORES_VALUES);
+    STATIC_REQUIRE(sizeof(vecs::SparseSet<Tag>) < sizeof(vecs::SparseSet<int>));
+
+    vecs::SparseSet<Tag> tags;
+    tags.emplace(5);
+    tags.emplace(9);
+
+    REQUIRE(tags.contains(5));
+    REQUIRE(tags.try_get(9) != nullptr);
+    REQUIRE(tags.erase(5));
+    REQUIRE(tags.entities()[0] == 9);
+    REQUIRE(tags.try_get(5) == nullptr);
+}
@@ -1,2 +1,784 @@
 #include <catch2/catch_all.hpp>
 
+// std
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <stdint.h>
+#include <atomic>
+#include <span>
+#include <tuple>
+
+// libs
+#include <vecs/entities.hpp>
+
+namespace {
+
+struct Position {
+    float x{}, y{};
+};
+
+struct Velocity {
+    float dx{}, dy{};
+};
+
+struct Name {
+    std::string value{};
+};
+
+struct Burning {
+    static constexpr vecs::ComponentStorage STORAGE = vecs::ComponentStorage::Sparse;
+    int ticks{};
+};
+
+struct Frozen {
+    static constexpr vecs::ComponentStorage STORAGE = vecs::ComponentStorage::Sparse;
+};
+
+struct Transform {
+    static constexpr vecs::ComponentStorage STORAGE = vecs::ComponentStorage::Sparse;
+    float x{}, y{}, z{};
+};
+
+struct RenderMesh {
+    static constexpr vecs::ComponentStorage STORAGE = vecs::ComponentStorage::Sparse;
+    uint32_t mesh{};
+};
+
+struct Counted {
+    static inline int alive {};
+    int value{};
+
+    explicit Counted(int value) : value(value) { ++alive; }
+    Counted(Counted&& other) noexcept : value(other.value) { ++alive; }
+    Counted& operator=(Counted&&) noexcept = default;
+    ~Counted() { --alive; }
+};
+
+struct Body {
+    float x{}, y{}, z{};
+    uint8_t layer{};
+};
+
+// Not an aggregate, VECS_SOA_FIELDS compares sizes instead.
+struct Spin {
+    Spin() = default;
+    Spin(float a, float r) : angle(a), rate(r) {}
+
+    float angle{};
+    float rate{};
+};
+
+struct SpinAngle {
+    float angle{};
+};
+
+struct SpinFields {
+    float angle{};
+    float rate{};
+};
+
+// Replacing or swapping it in a pool would need an assignment.
+struct Pinned {
+    float const x{}, y{};
+};
+
+} // namespace
+
+VECS_SOA_FIELDS(Body, x, y, z, layer);
+
+TEST_CASE("World adds, reads and removes components", "[world]") {
+    vecs::World world;
+
+    world.add_component(1, Position { 1.0f, 2.0f });
+    world.add_component(1, Velocity { 3.0f, 4.0f });
+    world.add_component(2, Position { 5.0f, 6.0f });
+
+    REQUIRE(world.has_component<Position>(1));
+    REQUIRE(world.has_component<Velocity>(1));
+    REQUIRE_FALSE(world.has_component<Velocity>(2));
+    REQUIRE_FALSE(world.has_component<Position>(42));
+    REQUIRE(world.get_component<Velocity>(2) == nullptr);
+
+    // Moving to the {Position, Velocity} table kept the position.
+    REQUIRE(world.get_component<Position>(1)->y == 2.0f);
+    REQUIRE(world.get_component<Velocity>(1)->dx == 3.0f);
+
+    // Overwrite in place.
+    world.add_component(2, Position { 7.0f, 8.0f });
+    REQUIRE(world.get_component<Position>(2)->x == 7.0f);
+
+    REQUIRE(world.remove_component<Position>(1));
+    REQUIRE_FALSE(world.remove_component<Position>(1));
+    REQUIRE_FALSE(world.has_component<Position>(1));
+    REQUIRE(world.get_component<Velocity>(1)->dy == 4.0f);
+
+    REQUIRE(world.remove_component<Velocity>(1));
+    REQUIRE_FALSE(world.has_component<Velocity>(1));
+    REQUIRE(world.get_component<Position>(2)->y == 8.0f);
+
+    // {Position}, {Position, Velocity} and {Velocity}.
+    REQUIRE(world.archetype_count() == 3);
+}
+
+TEST_CASE("World accepts scattered entity ids", "[world]") {
+    vecs::World world;
+
+    constexpr vecs::EntityId far = vecs::EntityId { 1 } << 30;
+    world.add_component(far, Position { 1.0f, 2.0f });
+    world.add_component(3, Position { 3.0f, 4.0f });
+    world.add_component(far, Velocity { 5.0f, 6.0f });
+
+    REQUIRE(world.get_component<Position>(far)->y == 2.0f);
+    REQUIRE(world.get_component<Velocity>(far)->dx == 5.0f);
+    REQUIRE(world.get_component<Position>(3)->x == 3.0f);
+    REQUIRE_FALSE(world.has_component<Position>(far + 1));
+    REQUIRE(world.get_component<Position>(far - 1) == nullptr);
+
+    world.destroy_entity(far);
+    REQUIRE_FALSE(world.has_component<Position>(far));
+    REQUIRE(world.get_component<Position>(3)->y == 4.0f);
+
+    // Ids past the index of an Entity cannot come from create_entity().
+    REQUIRE_THROWS_AS(world.add_component(vecs::EntityId { 1 } << 40, Position {}), std::out_of_range);
+    REQUIRE_FALSE(world.has_component<Position>(vecs::EntityId { 1 } << 40));
+}
+
+TEST_CASE("World iterates matching archetypes across chunks", "[world]") {
+    vecs::World world;
+    constexpr vecs::EntityId COUNT = 20'000;
+
+    for (vecs::EntityId e{}; e < COUNT; ++e) {
+        world.add_component(e, Position { static_cast<float>(e), 0.0f });
+
+        if (e % 2 == 0) {
+            world.add_component(e, Velocity { 1.0f, 2.0f });
+        }
+
+        if (e % 3 == 0) {
+            world.add_component(e, Name { "entity" });
+        }
+    }
+
+    world.each<Position, Velocity>([](Position& position, Velocity const& velocity) {
+        position.x += velocity.dx;
+        position.y += velocity.dy;
+    });
+
+    size_t moved{};
+    size_t still{};
+
+    world.each<Position>([&](vecs::EntityId e, Position const& position) {
+        if (e % 2 == 0) {
+            REQUIRE(position.x == static_cast<float>(e) + 1.0f);
+            ++moved;
+        }
+        else {
+            REQUIRE(position.y == 0.0f);
+            ++still;
+        }
+    });
+
+    REQUIRE(moved == COUNT / 2);
+    REQUIRE(still == COUNT / 2);
+
+    // Destroying entities swaps rows around, records must follow.
+    for (vecs::EntityId e{}; e < COUNT; e += 4) {
+        world.destroy_entity(e);
+    }
+
+    size_t names{};
+    world.each<Name, Position>([&](vecs::EntityId e, Name const& name, Position const& position) {
+        REQUIRE(e % 4 != 0);
+        REQUIRE(name.value == "entity");
+        REQUIRE(position.x >= static_cast<float>(e));
+        ++names;
+    });
+
+    REQUIRE(names == 5000); // Multiples of 3 minus multiples of 12.
+
+    for (vecs::EntityId e { 1 }; e < COUNT; e += 4) {
+        REQUIRE(world.get_component<Position>(e)->x == static_cast<float>(e));
+    }
+}
+
+TEST_CASE("World keeps sparse components out of archetypes", "[world]") {
+    vecs::World world;
+
+    for (vecs::EntityId e{}; e < 100; ++e) {
+        world.add_component(e, Position { static_cast<float>(e), 0.0f });
+    }
+
+    auto* position = world.get_component<Position>(10);
+
+    // High churn, the entity never changes table.
+    for (int round{}; round < 10; ++round) {
+        world.add_component(10, Burning { round });
+        REQUIRE(world.get_component<Burning>(10)->ticks == round);
+        REQUIRE(world.remove_component<Burning>(10));
+    }
+
+    REQUIRE(world.archetype_count() == 1);
+    REQUIRE(world.get_component<Position>(10) == position);
+    REQUIRE_FALSE(world.has_component<Burning>(10));
+    REQUIRE_FALSE(world.remove_component<Frozen>(10));
+
+    for (vecs::EntityId e{}; e < 100; e += 10) {
+        world.add_component(e, Burning { static_cast<int>(e) });
+    }
+
+    for (vecs::EntityId e{}; e < 100; e += 20) {
+        world.add_component(e, Frozen {});
+    }
+
+    // Archetype driven, sparse looked up per entity.
+    size_t burning{};
+    world.each<Position, Burning const>([&](vecs::EntityId e, Position& p, Burning const& b) {
+        REQUIRE(e % 10 == 0);
+        REQUIRE(b.ticks == static_cast<int>(e));
+        p.y = 1.0f;
+        ++burning;
+    });
+
+    REQUIRE(burning == 10);
+    REQUIRE(world.get_component<Position>(30)->y == 1.0f);
+    REQUIRE(world.get_component<Position>(31)->y == 0.0f);
+
+    // Sparse only, driven by the smaller pool.
+    size_t both{};
+    world.each<Burning, Frozen>([&](vecs::EntityId e, Burning&, Frozen&) {
+        REQUIRE(e % 20 == 0);
+        ++both;
+    });
+
+    REQUIRE(both == 5);
+
+    world.destroy_entity(20);
+    REQUIRE_FALSE(world.has_component<Burning>(20));
+    REQUIRE_FALSE(world.has_component<Frozen>(20));
+    REQUIRE_FALSE(world.has_component<Position>(20));
+    REQUIRE(world.get_component<Burning>(40)->ticks == 40);
+
+    size_t none{};
+    vecs::World empty;
+    empty.each<Position, Burning>([&](Position&, Burning&) { ++none; });
+    REQUIRE(none == 0);
+}
+
+TEST_CASE("World stores plain value components", "[world]") {
+    STATIC_REQUIRE(vecs::Component<Position>);
+    STATIC_REQUIRE(!std::is_polymorphic_v<Position>);
+    STATIC_REQUIRE(!vecs::Component<Position const>);
+    STATIC_REQUIRE(!vecs::Component<Pinned>);
+
+    {
+        vecs::World world;
+
+        auto& position = world.emplace_component<Position>(1, 1.0f, 2.0f);
+        REQUIRE(position.y == 2.0f);
+
+        world.emplace_component<Burning>(1, 3);
+        REQUIRE(world.get_component<Burning>(1)->ticks == 3);
+
+        // Pools own the lifetime, moves between tables do not leak or double destroy.
+        for (vecs::EntityId e{}; e < 50; ++e) {
+            world.emplace_component<Counted>(e, static_cast<int>(e));
+            world.add_component(e, Velocity { 1.0f, 1.0f });
+        }
+
+        REQUIRE(Counted::alive == 50);
+
+        for (vecs::EntityId e{}; e < 50; e += 2) {
+            REQUIRE(world.remove_component<Velocity>(e));
+        }
+
+        world.destroy_entity(7);
+        REQUIRE(Counted::alive == 49);
+        REQUIRE(world.get_component<Counted>(8)->value == 8);
+        REQUIRE(world.get_component<Counted>(9)->value == 9);
+    }
+
+    REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("Component ids are dense and per type", "[world]") {
+    struct A {};
+    struct B {};
+
+    auto const a = vecs::component_id<A>();
+    auto const b = vecs::component_id<B>();
+
+    REQUIRE(a != b);
+    REQUIRE(vecs::component_id<A>() == a);
+    REQUIRE(vecs::component_id<A const>() == a);
+    REQUIRE(vecs::component_id<Position>() < vecs::detail::TypeCounter<vecs::detail::ComponentFamily>::next.load());
+    REQUIRE(vecs::component_info<B>().id == b);
+}
+
+TEST_CASE("World views pick the smaller side as the driver", "[world]") {
+    vecs::World world;
+
+    for (vecs::EntityId e{}; e < 1000; ++e) {
+        world.add_component(e, Burning { static_cast<int>(e) });
+
+        if (e % 100 == 0) {
+            world.add_component(e, Position { static_cast<float>(e), 0.0f });
+        }
+    }
+
+    // 10 archetype rows against 1000 pool entries: the archetype drives.
+    std::vector<vecs::EntityId> visited{};
+    world.view<Position const, Burning>().each([&](vecs::EntityId e, Position const& p, Burning& b) {
+        REQUIRE(p.x == static_cast<float>(e));
+        b.ticks = -1;
+        visited.push_back(e);
+    });
+
+    REQUIRE(visited.size() == 10);
+    REQUIRE(world.get_component<Burning>(300)->ticks == -1);
+    REQUIRE(world.get_component<Burning>(301)->ticks == 301);
+
+    // Archetype only: rows come out table by table, chunk by chunk.
+    float sum{};
+    auto view = world.view<Position>();
+    view.each([&](Position const& p) { sum += p.x; });
+    REQUIRE(sum == 4500.0f);
+
+    // Sparse type with no pool yet matches nothing.
+    size_t frozen{};
+    world.view<Position, Frozen>().each([&](Position&, Frozen&) { ++frozen; });
+    REQUIRE(frozen == 0);
+}
+
+TEST_CASE("World queries cache their matching tables", "[world]") {
+    vecs::World world;
+
+    world.add_component(1, Position { 1.0f, 0.0f });
+    world.add_component(2, Position { 2.0f, 0.0f });
+    world.add_component(2, Velocity { 1.0f, 0.0f });
+
+    auto& moving = world.query<Position, Velocity const>();
+    REQUIRE(&moving == &world.query<Position, Velocity const>());
+    REQUIRE(moving.table_count() == 1);
+
+    auto& positions = world.query<Position const>();
+    REQUIRE(positions.table_count() == 2);
+
+    // New archetypes are pushed to the queries that match them.
+    world.add_component(3, Position { 3.0f, 0.0f });
+    world.add_component(3, Velocity { 1.0f, 0.0f });
+    world.add_component(3, Name { "three" });
+
+    REQUIRE(moving.table_count() == 2);
+    REQUIRE(positions.table_count() == 3);
+
+    moving.each([](Position& p, Velocity const& v) { p.x += v.dx; });
+    REQUIRE(world.get_component<Position>(1)->x == 1.0f);
+    REQUIRE(world.get_component<Position>(2)->x == 3.0f);
+    REQUIRE(world.get_component<Position>(3)->x == 4.0f);
+
+    // Mixed with sparse types, still over the cached tables.
+    world.add_component(3, Burning { 5 });
+    size_t burning{};
+    world.query<Position, Burning>().each([&](vecs::EntityId e, Position&, Burning&) {
+        REQUIRE(e == 3);
+        ++burning;
+    });
+    REQUIRE(burning == 1);
+
+    // Emptied tables are pruned and forgotten.
+    world.destroy_entity(3);
+    auto const before = world.archetype_count();
+    REQUIRE(world.prune_archetypes() > 0);
+    REQUIRE(world.archetype_count() < before);
+    REQUIRE(moving.table_count() == 1);
+
+    world.add_component(4, Position { 0.0f, 0.0f });
+    world.add_component(4, Velocity { 0.0f, 0.0f });
+    world.add_component(4, Name { "four" });
+    REQUIRE(moving.table_count() == 2);
+
+    size_t count{};
+    moving.each([&](Position&, Velocity const&) { ++count; });
+    REQUIRE(count == 2);
+}
+
+TEST_CASE("World owning groups keep their pools co-sorted", "[world][group]") {
+    vecs::World world;
+
+    // Members before the group exists get packed when it is built.
+    for (vecs::EntityId e{}; e < 100; ++e) {
+        world.add_component(e, Transform { static_cast<float>(e) });
+
+        if (e % 3 == 0) {
+            world.add_component(e, RenderMesh { static_cast<uint32_t>(e) });
+        }
+    }
+
+    auto& group = world.group<Transform, RenderMesh const>();
+    REQUIRE(&group == &world.group<Transform const, RenderMesh>());
+    REQUIRE(group.size() == 34);
+    REQUIRE_THROWS_AS(static_cast<void>(world.group<RenderMesh, Burning>()), std::logic_error);
+
+    auto const check_packed = [&] {
+        auto transforms = world.view<Transform>();
+        size_t members{};
+
+        for (size_t i{}; i < group.size(); ++i) {
+            auto const e = group.entities()[i];
+            REQUIRE(world.has_component<RenderMesh>(e));
+            REQUIRE(world.get_component<Transform>(e)->x == static_cast<float>(e));
+            REQUIRE(world.get_component<RenderMesh>(e)->mesh == e);
+        }
+
+        transforms.each([&](vecs::EntityId e, Transform&) {
+            members += world.has_component<RenderMesh>(e) ? 1 : 0;
+            REQUIRE(group.contains(e) == world.has_component<RenderMesh>(e));
+        });
+
+        REQUIRE(members == group.size());
+    };
+
+    check_packed();
+
+    // Joining and leaving through add, remove and destroy.
+    for (vecs::EntityId e { 1 }; e < 100; e += 3) {
+        world.add_component(e, RenderMesh { static_cast<uint32_t>(e) });
+    }
+
+    world.add_component(500, RenderMesh { 500 });
+    REQUIRE(group.size() == 67);
+    REQUIRE_FALSE(group.contains(500));
+
+    REQUIRE(world.remove_component<Transform>(0));
+    REQUIRE(world.remove_component<RenderMesh>(3));
+    world.destroy_entity(4);
+    world.add_component(6, RenderMesh { 6 }); // Overwrite, stays in.
+
+    REQUIRE(group.size() == 64);
+    check_packed();
+
+    size_t visited{};
+    group.each([&](vecs::EntityId e, Transform& t, RenderMesh const& m) {
+        REQUIRE(t.x == static_cast<float>(m.mesh));
+        REQUIRE(e == m.mesh);
+        t.y = 1.0f;
+        ++visited;
+    });
+
+    REQUIRE(visited == 64);
+    REQUIRE(world.get_component<Transform>(7)->y == 1.0f);
+    REQUIRE(world.get_component<Transform>(8)->y == 0.0f);
+}
+
+TEST_CASE("Benchmark owning group against a view", "[!benchmark][world][group]") {
+    constexpr vecs::EntityId COUNT = 100'000;
+
+    vecs::World unsorted;
+    vecs::World grouped;
+    auto& group = grouped.group<Transform, RenderMesh>();
+
+    // Every other entity has both, in shuffled pool orders for the view.
+    for (auto* world: { &unsorted, &grouped }) {
+        for (vecs::EntityId e{}; e < COUNT; ++e) {
+            world->add_component(e, Transform { static_cast<float>(e) });
+        }
+
+        for (vecs::EntityId e{}; e < COUNT; e += 2) {
+            world->add_component((e * 7919) % COUNT, RenderMesh { static_cast<uint32_t>(e) });
+        }
+    }
+
+    REQUIRE(group.size() == COUNT / 2);
+
+    BENCHMARK("view<Transform, RenderMesh>") {
+        float sum{};
+        unsorted.each<Transform const, RenderMesh const>([&](Transform const& t, RenderMesh const& m) { sum += t.x + static_cast<float>(m.mesh); });
+        return sum;
+    };
+
+    BENCHMARK("group<Transform, RenderMesh>") {
+        float sum{};
+        group.each([&](Transform const& t, RenderMesh const& m) { sum += t.x + static_cast<float>(m.mesh); });
+        return sum;
+    };
+}
+
+TEST_CASE("World allocates entities with generational handles", "[world]") {
+    vecs::World world;
+
+    std::vector<vecs::Entity> entities{};
+    for (int i{}; i < 100; ++i) {
+        entities.push_back(world.create_entity());
+    }
+
+    // Dense ids from 0.
+    for (size_t i{}; i < entities.size(); ++i) {
+        REQUIRE(entities[i].index() == i);
+        REQUIRE(world.is_alive(entities[i]));
+    }
+
+    REQUIRE_FALSE(world.is_alive(vecs::Entity{}));
+
+    auto const old = entities[42];
+    world.add_component(old, Position { 1.0f, 2.0f });
+    world.add_component(old, Burning { 3 });
+    REQUIRE(world.get_component<Position>(old)->y == 2.0f);
+
+    REQUIRE(world.destroy_entity(old));
+    REQUIRE_FALSE(world.destroy_entity(old));
+    REQUIRE_FALSE(world.is_alive(old));
+    REQUIRE(world.entity_count() == 99);
+
+    // The id comes back with a new generation, the old handle stays dead.
+    auto const reused = world.create_entity();
+    REQUIRE(reused.index() == old.index());
+    REQUIRE(reused.generation() != old.generation());
+    REQUIRE(world.is_alive(reused));
+    REQUIRE_FALSE(world.is_alive(old));
+
+    REQUIRE_FALSE(world.has_component<Position>(reused));
+    REQUIRE_FALSE(world.has_component<Burning>(reused));
+    REQUIRE(world.get_component<Position>(old) == nullptr);
+    REQUIRE_FALSE(world.remove_component<Position>(old));
+
+    // The id alone gives back the live handle.
+    REQUIRE(world.entity(old.index()) == reused);
+    REQUIRE(world.entity(entities[7].index()) == entities[7]);
+    REQUIRE_FALSE(world.is_alive(world.entity(100)));
+    REQUIRE_FALSE(world.is_alive(world.entity(vecs::EntityId { 1 } << 40)));
+
+    // Adding through a stale handle never reaches the entity that reused the id.
+    REQUIRE_THROWS_AS(world.add_component(old, Position { 6.0f, 6.0f }), std::invalid_argument);
+    REQUIRE_THROWS_AS(world.emplace_component<Burning>(old, 6), std::invalid_argument);
+    REQUIRE_FALSE(world.has_component<Position>(reused));
+    REQUIRE_FALSE(world.has_component<Burning>(reused));
+
+    world.emplace_component<Velocity>(reused, 1.0f, 0.0f);
+    REQUIRE(world.has_component<Velocity>(reused));
+    REQUIRE_FALSE(world.has_component<Velocity>(old));
+    REQUIRE(world.remove_component<Velocity>(reused));
+
+    // Destroyed last, reused first.
+    world.destroy_entity(entities[10]);
+    world.destroy_entity(entities[20]);
+    REQUIRE(world.create_entity().index() == 20);
+    REQUIRE(world.create_entity().index() == 10);
+    REQUIRE(world.create_entity().index() == 100);
+}
+
+TEST_CASE("World views iterate chunks in parallel", "[world][parallel]") {
+    vecs::JobSystem jobs { 4 };
+    vecs::World world;
+    constexpr vecs::EntityId COUNT = 200'000;
+
+    for (vecs::EntityId e{}; e < COUNT; ++e) {
+        world.add_component(e, Position { static_cast<float>(e), 0.0f });
+        world.add_component(e, Transform { 0.0f });
+
+        if (e % 2 == 0) {
+            world.add_component(e, Velocity { 1.0f, 0.0f });
+        }
+
+        if (e % 100 == 0) {
+            world.add_component(e, RenderMesh { 1 });
+        }
+    }
+
+    auto& group = world.group<Transform, RenderMesh>();
+
+    // Several frames, so the grain adapts between them.
+    for (int frame{}; frame < 5; ++frame) {
+        world.view<Position, Velocity const>().par_each([](Position& p, Velocity const& v) { p.y += v.dx; }, jobs);
+        world.query<Position>().par_each([](vecs::EntityId, Position& p) { p.x += 1.0f; }, jobs);
+
+        // Pool driven, then packed group ranges.
+        std::atomic<size_t> meshes{};
+        world.view<Position const, RenderMesh>().par_each([&](Position const&, RenderMesh& m) { m.mesh += 1; ++meshes; }, jobs);
+        group.par_each([](Transform& t, RenderMesh const&) { t.z += 1.0f; }, jobs);
+
+        REQUIRE(meshes == COUNT / 100);
+    }
+
+    size_t wrong{};
+    world.each<Position const>([&](vecs::EntityId e, Position const& p) {
+        wrong += p.x == static_cast<float>(e) + 5.0f && p.y == (e % 2 == 0 ? 5.0f : 0.0f) ? 0 : 1;
+    });
+
+    REQUIRE(wrong == 0);
+    REQUIRE(world.get_component<RenderMesh>(300)->mesh == 6);
+    REQUIRE(world.get_component<Transform>(300)->z == 5.0f);
+    REQUIRE(world.get_component<Transform>(301)->z == 0.0f);
+
+    // Nothing to do, nothing to split.
+    vecs::World empty;
+    empty.view<Position>().par_each([](Position&) {}, jobs);
+}
+
+TEST_CASE("World views hand out aligned chunk spans", "[world]") {
+    vecs::World world;
+    constexpr vecs::EntityId COUNT = 5'000; // Several chunks per table.
+
+    for (vecs::EntityId e{}; e < COUNT; ++e) {
+        world.add_component(e, Position { static_cast<float>(e), 0.0f });
+        world.add_component(e, Velocity { 1.0f, 2.0f });
+
+        if (e % 2 == 0) {
+            world.add_component(e, Name { "even" });
+        }
+    }
+
+    size_t chunks{};
+    size_t rows{};
+    bool aligned { true };
+
+    world.view<Position, Velocity const>().each_chunk([&](std::span<Position> positions, std::span<Velocity const> velocities) {
+        REQUIRE(positions.size() == velocities.size());
+        aligned = aligned && reinterpret_cast<uintptr_t>(positions.data()) % vecs::CACHE_LINE_SIZE == 0;
+        aligned = aligned && reinterpret_cast<uintptr_t>(velocities.data()) % vecs::CACHE_LINE_SIZE == 0;
+
+        for (size_t i{}; i < positions.size(); ++i) {
+            positions[i].x += velocities[i].dx;
+            positions[i].y += velocities[i].dy;
+        }
+
+        ++chunks;
+        rows += positions.size();
+    });
+
+    REQUIRE(aligned);
+    REQUIRE(rows == COUNT);
+    REQUIRE(chunks > 2);
+    REQUIRE(world.get_component<Position>(7)->x == 8.0f);
+    REQUIRE(world.get_component<Position>(8)->y == 2.0f);
+
+    // With entity ids, over the cached tables of a query.
+    size_t named{};
+    world.query<Position const, Name const>().each_chunk([&](std::span<vecs::EntityId const> entities, std::span<Position const> positions, std::span<Name const>) {
+        for (size_t i{}; i < entities.size(); ++i) {
+            named += positions[i].x == static_cast<float>(entities[i]) + 1.0f ? 1 : 0;
+        }
+    });
+
+    REQUIRE(named == COUNT / 2);
+
+    // A group hands out its packed range in one call.
+    for (vecs::EntityId e{}; e < 10; ++e) {
+        world.add_component(e, Transform { 0.0f, 0.0f, static_cast<float>(e) });
+        world.add_component(e, RenderMesh { static_cast<uint32_t>(e) });
+    }
+
+    world.add_component(42, Transform {});
+
+    size_t calls{};
+    world.group<Transform, RenderMesh>().each_chunk([&](std::span<Transform> transforms, std::span<RenderMesh const> meshes) {
+        REQUIRE(transforms.size() == 10);
+        for (size_t i{}; i < transforms.size(); ++i) {
+            REQUIRE(transforms[i].z == static_cast<float>(meshes[i].mesh));
+        }
+
+        ++calls;
+    });
+
+    REQUIRE(calls == 1);
+}
+
+TEST_CASE("World stores split components one array per field", "[world]") {
+    // A field left out of VECS_SOA_FIELDS would be lost, it does not compile.
+    using body_members_t = std::tuple<float Body::*, float Body::*, float Body::*, uint8_t Body::*>;
+    using partial_members_t = std::tuple<float Body::*, float Body::*, float Body::*>;
+    STATIC_REQUIRE(vecs::detail::soa_covers_v<Body, body_members_t, void>);
+    STATIC_REQUIRE_FALSE(vecs::detail::soa_covers_v<Body, partial_members_t, void>);
+    STATIC_REQUIRE(vecs::detail::soa_covers_v<Spin, std::tuple<float Spin::*, float Spin::*>, SpinFields>);
+    STATIC_REQUIRE_FALSE(vecs::detail::soa_covers_v<Spin, std::tuple<float Spin::*>, SpinAngle>);
+
+    vecs::World world;
+    constexpr vecs::EntityId COUNT = 3'000;
+
+    for (vecs::EntityId e{}; e < COUNT; ++e) {
+        world.add_component(e, Body { static_cast<float>(e), 1.0f, 2.0f, 3 });
+
+        if (e % 3 == 0) {
+            world.add_component(e, Name { "third" });
+        }
+    }
+
+    static_assert(std::is_same_v<decltype(world.get_component<Body>(0)), vecs::SoaPtr<Body>>);
+
+    REQUIRE(world.get_component<Body>(COUNT) == nullptr);
+    REQUIRE(world.get_component<Body>(7)->x == 7.0f);
+    REQUIRE(world.get_component<Body>(7)->layer == 3);
+
+    // Overwrite in place, then move to another table and back.
+    world.emplace_component<Body>(9, 90.0f, 0.0f, 0.0f, uint8_t { 1 }).y = 5.0f;
+    world.add_component(9, Velocity { 1.0f, 1.0f });
+    REQUIRE(world.remove_component<Name>(9));
+    REQUIRE(world.remove_component<Velocity>(9));
+
+    auto const moved = world.get_component<Body>(9);
+    REQUIRE(moved->x == 90.0f);
+    REQUIRE(moved->y == 5.0f);
+    REQUIRE(moved->layer == 1);
+
+    // The last row fills the hole, field by field.
+    world.destroy_entity(10);
+    REQUIRE(world.get_component<Body>(10) == nullptr);
+    REQUIRE(world.get_component<Body>(COUNT - 1)->x == static_cast<float>(COUNT - 1));
+
+    world.view<Body>().each([](vecs::soa_ref_t<Body> body) { body.z += body.x; });
+    world.view<Body>().par_each([](auto& body) { body.y += 1.0f; });
+
+    float z_sum{};
+    world.each<Body const>([&](vecs::EntityId e, vecs::soa_ref_t<Body const> body) {
+        z_sum += body.z - (e == 9 ? 90.0f : static_cast<float>(e));
+    });
+
+    REQUIRE(z_sum == 2.0f * (COUNT - 2)); // Entity 9 was rebuilt with z = 0.
+    REQUIRE(world.get_component<Body>(9)->y == 6.0f);
+
+    // Chunks hand out one aligned span per field.
+    size_t rows{};
+    bool aligned { true };
+
+    world.view<Body>().each_chunk([&](vecs::soa_spans_t<Body> body) {
+        REQUIRE(body.x.size() == body.layer.size());
+        aligned = aligned && reinterpret_cast<uintptr_t>(body.x.data()) % vecs::CACHE_LINE_SIZE == 0;
+        aligned = aligned && reinterpret_cast<uintptr_t>(body.layer.data()) % vecs::CACHE_LINE_SIZE == 0;
+
+        for (size_t i{}; i < body.x.size(); ++i) {
+            body.x[i] = 0.0f;
+        }
+
+        rows += body.x.size();
+    });
+
+    REQUIRE(aligned);
+    REQUIRE(rows == COUNT - 1);
+    REQUIRE(world.get_component<Body>(5)->x == 0.0f);
+    REQUIRE(world.get_component<Body>(5)->y == 2.0f);
+}
+
+TEST_CASE("Benchmark view each against par_each", "[!benchmark][world][parallel]") {
+    vecs::World world;
+    constexpr vecs::EntityId COUNT = 1'000'000;
+
+    for (vecs::EntityId e{}; e < COUNT; ++e) {
+        world.add_component(e, Position { static_cast<float>(e), 0.0f });
+        world.add_component(e, Velocity { 1.0f, 0.5f });
+    }
+
+    auto const move = [](Position& p, Velocity const& v) {
+        p.x += v.dx * 0.016f;
+        p.y += v.dy * 0.016f;
+    };
+
+    BENCHMARK("each, 1M entities") {
+        world.view<Position, Velocity const>().each(move);
+    };
+
+    BENCHMARK("par_each, 1M entities") {
+        world.view<Position, Velocity const>().par_each(move);
+    };
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+// std
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+#include <cassert>
+
+#include "config.hpp"
+#include "component.hpp"
+#include "entities.hpp"
+#include "data_structures/storage.hpp"
+
+namespace vecs {
+
+/*
+    Records structural changes (create, destroy, add, remove) to replay
+    them on a World later, at a sync point where nothing iterates it.
+    Systems can then change entities while walking a view.
+
+    Component payloads are moved into a byte arena made of fixed blocks
+    that never reallocate, so payloads stay where they were built until
+    apply(). Blocks are kept by clear() and apply(), a buffer reused every
+    frame stops allocating once it has seen its largest frame.
+
+    apply() replays in batches instead of recording order:
+    1. every entity created through the buffer, in order;
+    2. adds and removes, stable sorted by component type then entity, so
+       each pool is touched in one run and archetype moves follow the same
+       table edge back to back. Operations on different component types
+       commute, the ones on the same type keep their recorded order;
+    3. destroys. Commands on an entity destroyed by the same buffer are
+       dropped, so are commands on stale handles.
+*/
+class CommandBuffer {
+public:
+    static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+private:
+    enum class Kind : uint8_t { Destroy, Emplace, Remove };
+
+    struct Command {
+        Entity entity;
+        ComponentId component;
+        Kind kind;
+        void* payload;                             // Emplace only, the parked component.
+        void (*apply)(World&, EntityId, void*);    // Consumes the payload.
+        void (*drop)(void*) noexcept;              // Destroys a payload never applied.
+    };
+
+    struct Block {
+        page_ptr<std::byte, CACHE_LINE_SIZE> bytes;
+        size_t size;
+    };
+
+    std::vector<Command> _commands{};
+    std::vector<Block> _blocks{};
+    size_t _block{};  // Block being filled.
+    size_t _offset{}; // Bump offset inside it.
+    uint32_t _created{};
+
+public:
+    CommandBuffer() = default;
+    CommandBuffer(CommandBuffer const&) = delete;
+    CommandBuffer& operator=(CommandBuffer const&) = delete;
+
+    CommandBuffer(CommandBuffer&& other) noexcept
+        : _commands(std::move(other._commands)), _blocks(std::move(other._blocks)),
+          _block(std::exchange(other._block, 0)), _offset(std::exchange(other._offset, 0)),
+          _created(std::exchange(other._created, 0)) {}
+
+    CommandBuffer&
+    operator=(CommandBuffer&& other) noexcept {
+        if (this != &other) {
+            _drop_payloads();
+            _commands = std::move(other._commands);
+            _blocks = std::move(other._blocks);
+            _block = std::exchange(other._block, 0);
+            _offset = std::exchange(other._offset, 0);
+            _created = std::exchange(other._created, 0);
+        }
+
+        return *this;
+    }
+
+    ~CommandBuffer() {
+        _drop_payloads();
+    }
+
+    [[nodiscard]] inline size_t size() const noexcept { return _commands.size() + _created; }
+    [[nodiscard]] inline bool empty() const noexcept { return size() == 0; }
+
+    /*
+        Placeholder for an entity apply() creates. Only this buffer
+        understands it (its generation is 0, never alive in a World), use
+        it with the other commands of the buffer.
+    */
+    [[nodiscard]]
+    Entity
+    create_entity() noexcept {
+        return EntityKey::make(_created++, 0);
+    }
+
+    void
+    destroy_entity(Entity entity) {
+        _commands.push_back({ entity, 0, Kind::Destroy, nullptr, nullptr, nullptr });
+    }
+
+    template <Component T>
+    void
+    add_component(Entity entity, T component) {
+        emplace_component<T>(entity, std::move(component));
+    }
+
+    // Builds the component now, in the arena, and moves it into the World on apply().
+    template <Component T, typename... Args>
+    void
+    emplace_component(Entity entity, Args&&... args) {
+        // The push_back below must not throw once the payload exists. Grow geometrically, reserve(size + 1) would copy every time.
+        if (_commands.size() == _commands.capacity()) {
+            _commands.reserve(std::max<size_t>(16, 2 * _commands.capacity()));
+        }
+
+        auto* payload = std::construct_at(static_cast<T*>(_allocate(sizeof(T), alignof(T))), std::forward<Args>(args)...);
+
+        _commands.push_back({
+            entity,
+            component_id<T>(),
+            Kind::Emplace,
+            payload,
+            [](World& world, EntityId id, void* p) {
+                auto* component = static_cast<T*>(p);
+                world.emplace_component<T>(id, std::move(*component));
+                std::destroy_at(component);
+            },
+            [](void* p) noexcept { std::destroy_at(static_cast<T*>(p)); },
+        });
+    }
+
+    template <Component T>
+    void
+    remove_component(Entity entity) {
+        _commands.push_back({
+            entity,
+            component_id<T>(),
+            Kind::Remove,
+            nullptr,
+            [](World& world, EntityId id, void*) { world.remove_component<T>(id); },
+            nullptr,
+        });
+    }
+
+    /*
+        Replays every command on 'world' (see the class comment for the
+        order), then clears the buffer. Returns the entities created, in
+        create_entity() order.
+    */
+    std::vector<Entity>
+    apply(World& world) {
+        std::vector<Entity> created{};
+
+        try {
+            created.reserve(_created);
+            for (uint32_t i{}; i < _created; ++i) {
+                created.push_back(world.create_entity());
+            }
+
+            // Placeholders this buffer never handed out stay as they are, never alive.
+            auto const resolve = [&](Entity entity) {
+                return entity.generation() == 0 && entity.index() < created.size() ? created[entity.index()] : entity;
+            };
+
+            std::vector<Entity> destroyed{};
+            std::vector<Command*> changes{};
+
+            for (auto& command: _commands) {
+                if (command.kind != Kind::Destroy) {
+                    changes.push_back(&command);
+                }
+                else if (auto const entity = resolve(command.entity); world.is_alive(entity)) {
+                    destroyed.push_back(entity);
+                }
+            }
+
+            auto const by_index = [](Entity a, Entity b) { return a.index() < b.index(); };
+            std::sort(destroyed.begin(), destroyed.end(), by_index);
+            std::stable_sort(changes.begin(), changes.end(), [&](Command const* a, Command const* b) {
+                if (a->component != b->component) {
+                    return a->component < b->component;
+                }
+
+                return resolve(a->entity).index() < resolve(b->entity).index();
+            });
+
+            for (auto* command: changes) {
+                auto const entity = resolve(command->entity);
+
+                if (world.is_alive(entity) && !std::binary_search(destroyed.begin(), destroyed.end(), entity, by_index)) {
+                    command->apply(world, entity.index(), command->payload);
+                }
+                else if (command->payload != nullptr) {
+                    command->drop(command->payload);
+                }
+
+                command->payload = nullptr;
+            }
+
+            for (auto const entity: destroyed) {
+                world.destroy_entity(entity); // Repeated destroys find a stale handle.
+            }
+        }
+        catch (...) {
+            clear();
+            throw;
+        }
+
+        clear();
+
+        return created;
+    }
+
+    // Drops every recorded command, the arena blocks are kept for reuse.
+    void
+    clear() noexcept {
+        _drop_payloads();
+        _commands.clear();
+        _block = 0;
+        _offset = 0;
+        _created = 0;
+    }
+
+private:
+    [[nodiscard]]
+    void*
+    _allocate(size_t size, size_t alignment) {
+        while (_block < _blocks.size()) {
+            auto const offset = (_offset + alignment - 1) / alignment * alignment;
+
+            if (offset + size <= _blocks[_block].size) {
+                _offset = offset + size;
+                return _blocks[_block].bytes.get() + offset;
+            }
+
+            ++_block;
+            _offset = 0;
+        }
+
+        // Blocks are cache line aligned, so offset 0 suits any component.
+        auto const bytes = std::max(size, BLOCK_SIZE);
+        _blocks.push_back({ page_ptr<std::byte, CACHE_LINE_SIZE> { static_cast<std::byte*>(::operator new(bytes, std::align_val_t { CACHE_LINE_SIZE })) }, bytes });
+        _block = _blocks.size() - 1;
+        _offset = size;
+
+        return _blocks.back().bytes.get();
+    }
+
+    void
+    _drop_payloads() noexcept {
+        for (auto& command: _commands) {
+            if (command.payload != nullptr) {
+                command.drop(command.payload);
+                command.payload = nullptr;
+            }
+        }
+    }
+};
+
+/*
+    One CommandBuffer per thread, each on its own cache lines, so parallel
+    code records without locks or false sharing. Thread 'i' only touches
+    local(i). apply() replays the buffers in thread order: the result is
+    only deterministic when the work each thread records is, which work
+    stealing does not promise (the Scheduler keeps one buffer per system
+    for that reason).
+*/
+class ThreadCommandBuffers {
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        CommandBuffer buffer{};
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _count;
+
+public:
+    explicit ThreadCommandBuffers(size_t thread_count)
+        : _slots(std::make_unique<Slot[]>(thread_count)), _count(thread_count) {}
+
+    [[nodiscard]] inline size_t thread_count() const noexcept { return _count; }
+
+    [[nodiscard]]
+    CommandBuffer&
+    local(size_t thread) noexcept {
+        assert(thread < _count);
+        return _slots[thread].buffer;
+    }
+
+    // Call from a single thread, once every recording thread is done.
+    void
+    apply(World& world) {
+        for (size_t i{}; i < _count; ++i) {
+            _slots[i].buffer.apply(world);
+        }
+    }
+};
+
+} // namespace vecs
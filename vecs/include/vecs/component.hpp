@@ -0,0 +1,123 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <array>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <concepts>
+#include <span>
+#include <stdint.h>
+
+#include "config.hpp"
+#include "soa.hpp"
+#include "data_structures/storage.hpp"
+
+namespace vecs {
+
+using EntityId = size_t;
+
+/*
+    Any plain value type can be a component, no base class needed: pools
+    and archetypes store components by value and own their lifetime.
+    Components are moved between tables and move assigned when replaced or
+    swapped in a pool, so moving must not throw.
+*/
+template <typename T>
+concept Component = std::is_object_v<T>
+    && !std::is_const_v<T>
+    && std::is_nothrow_move_constructible_v<T>
+    && std::is_nothrow_move_assignable_v<T>
+    && std::is_nothrow_destructible_v<T>
+    && alignof(T) <= CACHE_LINE_SIZE; // Chunks are aligned to a cache line.
+
+/*
+    Dense id of a component type, handed out the first time the type asks
+    for one (0, 1, 2...), so containers can index flat arrays with it. No
+    RTTI involved, works with -fno-rtti. Ids are only stable within one run
+    of the program, never persist them.
+*/
+using ComponentId = uint32_t;
+
+namespace detail {
+
+// Hands out dense ids to types, in first use order, one sequence per 'TFamily'.
+template <typename TFamily>
+struct TypeCounter {
+    static inline std::atomic<uint32_t> next{};
+
+    template <typename T>
+    [[nodiscard]]
+    static uint32_t
+    id() noexcept {
+        static uint32_t const value = next.fetch_add(1, std::memory_order_relaxed);
+        return value;
+    }
+};
+
+struct ComponentFamily {};
+
+} // namespace detail
+
+template <typename T>
+[[nodiscard]]
+ComponentId
+component_id() noexcept {
+    return detail::TypeCounter<detail::ComponentFamily>::id<std::remove_cv_t<T>>();
+}
+
+/*
+    Everything an archetype needs to store a component type it only knows
+    at runtime: its size and alignment, and how to relocate (move into raw
+    memory, then destroy the source) and destroy one instance.
+
+    The flags let archetypes skip the calls: trivially relocatable types
+    are moved with memcpy, trivially destructible ones are never destroyed.
+    Split types (see soa.hpp) list their fields, archetypes give each one
+    its own array and never see a whole instance.
+*/
+struct ComponentInfo {
+    ComponentId id;
+    size_t size;
+    size_t alignment;
+    bool trivially_relocatable;
+    bool trivially_destructible;
+    void (*relocate)(void* destination, void* source) noexcept;
+    void (*destroy)(void* instance) noexcept;
+    std::span<FieldInfo const> fields; // Empty unless the type is split.
+};
+
+// One ComponentInfo per type, built on first use.
+template <Component T>
+[[nodiscard]]
+ComponentInfo const&
+component_info() noexcept {
+    static constexpr auto fields = [] {
+        if constexpr (SoaComponent<T>) {
+            static_assert(std::is_trivially_copyable_v<T>, "Split components must be trivially copyable.");
+            return detail::soa_field_infos<T>(std::make_index_sequence<detail::soa_field_count_v<T>>{});
+        }
+        else {
+            return std::array<FieldInfo, 0>{};
+        }
+    }();
+
+    static ComponentInfo const info {
+        .id                     = component_id<T>(),
+        .size                   = sizeof(T),
+        .alignment              = alignof(T),
+        .trivially_relocatable  = is_trivially_relocatable_v<T>,
+        .trivially_destructible = std::is_trivially_destructible_v<T>,
+        .relocate               = [](void* destination, void* source) noexcept {
+            std::construct_at(static_cast<T*>(destination), std::move(*static_cast<T*>(source)));
+            std::destroy_at(static_cast<T*>(source));
+        },
+        .destroy                = [](void* instance) noexcept { std::destroy_at(static_cast<T*>(instance)); },
+        .fields                 = fields,
+    };
+
+    return info;
+}
+
+} // namespace vecs
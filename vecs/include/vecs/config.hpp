@@ -0,0 +1,33 @@
+#pragma once
+
+// std
+#include <cstddef>
+
+/*
+    Compiler specific helpers shared by the whole library.
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+    // Read prefetch, keep the line in all cache levels.
+    #define VECS_PREFETCH(address) __builtin_prefetch((address), 0, 3)
+#elif defined(_MSC_VER)
+    #include <xmmintrin.h>
+    #define VECS_PREFETCH(address) _mm_prefetch(reinterpret_cast<char const*>(address), _MM_HINT_T0)
+#else
+    #define VECS_PREFETCH(address) ((void)(address))
+#endif
+
+// MSVC accepts [[no_unique_address]] but ignores it, it has its own spelling.
+#if defined(_MSC_VER) && !defined(__clang__)
+    #define VECS_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+    #define VECS_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+
+namespace vecs {
+
+// Assumed cache line size, std::hardware_destructive_interference_size is not portable enough yet.
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+} // namespace vecs
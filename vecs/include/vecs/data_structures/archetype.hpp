@@ -0,0 +1,335 @@
+#pragma once
+
+// std
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include <stdint.h>
+#include <cassert>
+
+#include "storage.hpp"
+#include "../config.hpp"
+#include "../component.hpp"
+
+namespace vecs {
+
+/*
+    Table holding every entity that has exactly the same set of component
+    types (its signature). Rows are split into fixed size chunks, inside a
+    chunk every component type is its own tightly packed array (SoA), next
+    to the array of entity ids, so a system walks plain arrays.
+
+    Rows are only reserved by push_row(), the caller constructs the
+    components in place. Removing a row moves the last row into the hole.
+
+    A split component (see soa.hpp) takes one array per field instead of
+    one array of whole values, field 'f' of it is reached with
+    chunk_field() and field_at().
+*/
+class Archetype {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t NO_COLUMN = static_cast<size_t>(-1);
+
+    // Archetypes reached by adding or removing one component type, filled lazily by the World.
+    struct Edges {
+        Archetype* add{};
+        Archetype* remove{};
+    };
+
+private:
+    using chunk_ptr = page_ptr<std::byte, CACHE_LINE_SIZE>;
+
+    std::vector<ComponentInfo const*> _infos{}; // Sorted by id, the signature.
+    std::vector<size_t> _offsets{};             // Byte offset of every array inside a chunk.
+    std::vector<size_t> _array_sizes{};         // Element size of every array.
+    std::vector<uint32_t> _first_array{};       // Column -> its first array, one more entry at the end.
+    std::vector<uint32_t> _columns{};           // ComponentId -> column, NO_COLUMN when absent.
+    size_t _chunk_capacity{};                   // Rows per chunk.
+    size_t _chunk_bytes{};
+
+    std::vector<chunk_ptr> _chunks{};
+    size_t _size{};
+
+    std::vector<Edges> _edges{}; // Indexed by ComponentId.
+
+public:
+    // 'infos' must be sorted by id and hold no duplicates.
+    explicit Archetype(std::vector<ComponentInfo const*> infos)
+        : _infos(std::move(infos)) {
+        assert(std::is_sorted(_infos.begin(), _infos.end(), [](auto* a, auto* b) { return a->id < b->id; }));
+
+        if (!_infos.empty()) {
+            _columns.resize(_infos.back()->id + 1, static_cast<uint32_t>(NO_COLUMN));
+        }
+
+        for (size_t c{}; c < _infos.size(); ++c) {
+            _columns[_infos[c]->id] = static_cast<uint32_t>(c);
+        }
+
+        size_t row_bytes { sizeof(EntityId) };
+        for (auto* info: _infos) {
+            _first_array.push_back(static_cast<uint32_t>(_array_sizes.size()));
+            row_bytes += info->size;
+
+            if (info->fields.empty()) {
+                _array_sizes.push_back(info->size);
+            }
+
+            for (auto const& field: info->fields) {
+                _array_sizes.push_back(field.size);
+            }
+        }
+
+        _first_array.push_back(static_cast<uint32_t>(_array_sizes.size()));
+
+        // Shrink the guess until the columns, padding included, fit the chunk.
+        _chunk_capacity = std::max<size_t>(CHUNK_SIZE / row_bytes, 1);
+        while (_layout_chunk() > CHUNK_SIZE && _chunk_capacity > 1) {
+            --_chunk_capacity;
+        }
+
+        _chunk_bytes = _layout_chunk();
+    }
+
+    Archetype(Archetype const&) = delete;
+    Archetype& operator=(Archetype const&) = delete;
+
+    ~Archetype() {
+        for (size_t c{}; c < _infos.size(); ++c) {
+            if (_infos[c]->trivially_destructible) {
+                continue;
+            }
+
+            for (size_t row{}; row < _size; ++row) {
+                _infos[c]->destroy(at(c, row));
+            }
+        }
+    }
+
+    [[nodiscard]] inline size_t size() const noexcept { return _size; }
+    [[nodiscard]] inline size_t column_count() const noexcept { return _infos.size(); }
+    [[nodiscard]] inline size_t chunk_capacity() const noexcept { return _chunk_capacity; }
+    [[nodiscard]] inline size_t chunk_count() const noexcept { return (_size + _chunk_capacity - 1) / _chunk_capacity; }
+    [[nodiscard]] inline ComponentInfo const& info(size_t column) const noexcept { return *_infos[column]; }
+    [[nodiscard]] inline size_t field_count(size_t column) const noexcept { return _first_array[column + 1] - _first_array[column]; }
+    [[nodiscard]] inline std::vector<ComponentInfo const*> const& infos() const noexcept { return _infos; }
+    [[nodiscard]]
+    Edges&
+    edges(ComponentId id) {
+        if (id >= _edges.size()) {
+            _edges.resize(id + 1);
+        }
+
+        return _edges[id];
+    }
+
+    // Forgets every edge leading to an archetype 'is_gone' says is about to be destroyed.
+    template <typename F>
+    void
+    drop_edges(F&& is_gone) noexcept {
+        for (auto& edge: _edges) {
+            edge.add    = (edge.add != nullptr && is_gone(edge.add)) ? nullptr : edge.add;
+            edge.remove = (edge.remove != nullptr && is_gone(edge.remove)) ? nullptr : edge.remove;
+        }
+    }
+
+    [[nodiscard]]
+    size_t
+    column_of(ComponentId id) const noexcept {
+        if (id >= _columns.size() || _columns[id] == static_cast<uint32_t>(NO_COLUMN)) {
+            return NO_COLUMN;
+        }
+
+        return _columns[id];
+    }
+
+    [[nodiscard]] inline bool has(ComponentId id) const noexcept { return column_of(id) != NO_COLUMN; }
+
+    // Rows stored in chunk 'chunk', only the last chunk may be partially filled.
+    [[nodiscard]]
+    size_t
+    chunk_size(size_t chunk) const noexcept {
+        return std::min(_chunk_capacity, _size - chunk * _chunk_capacity);
+    }
+
+    [[nodiscard]]
+    EntityId*
+    chunk_entities(size_t chunk) noexcept {
+        return reinterpret_cast<EntityId*>(_chunks[chunk].get());
+    }
+
+    // First element of 'column' inside 'chunk', as a packed array of that component.
+    [[nodiscard]]
+    void*
+    chunk_column(size_t chunk, size_t column) noexcept {
+        return chunk_field(chunk, column, 0);
+    }
+
+    // First element of field 'field' of a split 'column' inside 'chunk'.
+    [[nodiscard]]
+    void*
+    chunk_field(size_t chunk, size_t column, size_t field) noexcept {
+        return _chunks[chunk].get() + _offsets[_first_array[column] + field];
+    }
+
+    [[nodiscard]]
+    void*
+    at(size_t column, size_t row) noexcept {
+        return field_at(column, 0, row);
+    }
+
+    [[nodiscard]]
+    void*
+    field_at(size_t column, size_t field, size_t row) noexcept {
+        auto const array = _first_array[column] + field;
+        return _chunks[row / _chunk_capacity].get() + _offsets[array] + (row % _chunk_capacity) * _array_sizes[array];
+    }
+
+    [[nodiscard]]
+    EntityId
+    entity_at(size_t row) noexcept {
+        return chunk_entities(row / _chunk_capacity)[row % _chunk_capacity];
+    }
+
+    /*
+        Appends a row for 'entity' and returns it. Component memory of that
+        row is left raw, the caller constructs every column.
+    */
+    [[nodiscard]]
+    size_t
+    push_row(EntityId entity) {
+        if (_size == _chunks.size() * _chunk_capacity) {
+            // Owned before the vector may reallocate, a throwing push_back() frees it.
+            chunk_ptr chunk { static_cast<std::byte*>(::operator new(_chunk_bytes, std::align_val_t { CACHE_LINE_SIZE })) };
+            _chunks.push_back(std::move(chunk));
+        }
+
+        auto const row = _size++;
+        chunk_entities(row / _chunk_capacity)[row % _chunk_capacity] = entity;
+
+        return row;
+    }
+
+    /*
+        Drops a row pushed by push_row() before any of its components was
+        constructed (it must be the last one).
+    */
+    void
+    pop_raw_row() noexcept {
+        --_size;
+        _release_chunks();
+    }
+
+    /*
+        Destroys the components of 'row' and fills the hole with the last
+        row. Returns true when an entity moved into 'row'.
+    */
+    bool
+    destroy_row(size_t row) noexcept {
+        for (size_t c{}; c < _infos.size(); ++c) {
+            _destroy(c, row);
+        }
+
+        return _fill_hole(row);
+    }
+
+    /*
+        Relocates the components of 'row' that 'destination' also has into
+        its row 'destination_row', destroys the others, then fills the hole
+        with the last row. Returns true when an entity moved into 'row'.
+    */
+    bool
+    move_row(size_t row, Archetype& destination, size_t destination_row) noexcept {
+        for (size_t c{}; c < _infos.size(); ++c) {
+            auto const target = destination.column_of(_infos[c]->id);
+
+            if (target != NO_COLUMN) {
+                _relocate(c, destination, target, destination_row, row);
+            }
+            else {
+                _destroy(c, row);
+            }
+        }
+
+        return _fill_hole(row);
+    }
+
+private:
+    /*
+        Lays out the arrays for the current chunk capacity, returns the
+        bytes needed. Every array starts on a cache line, so the arrays a
+        system gets from View::each_chunk() are aligned for wide loads.
+    */
+    size_t
+    _layout_chunk() {
+        size_t offset { sizeof(EntityId) * _chunk_capacity };
+        _offsets.clear();
+
+        for (auto const size: _array_sizes) {
+            offset = (offset + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+            _offsets.push_back(offset);
+            offset += size * _chunk_capacity;
+        }
+
+        return offset;
+    }
+
+    // Swap-and-pop over raw component memory, the last row is relocated into 'row'.
+    bool
+    _fill_hole(size_t row) noexcept {
+        auto const last = _size - 1;
+        auto const moved = (row != last);
+
+        if (moved) {
+            for (size_t c{}; c < _infos.size(); ++c) {
+                _relocate(c, *this, c, row, last);
+            }
+
+            chunk_entities(row / _chunk_capacity)[row % _chunk_capacity] = entity_at(last);
+        }
+
+        --_size;
+        _release_chunks();
+
+        return moved;
+    }
+
+    // Moves 'row' of 'column' into 'destination_row' of 'destination_column' in 'destination', split fields one by one.
+    void
+    _relocate(size_t column, Archetype& destination, size_t destination_column, size_t destination_row, size_t row) noexcept {
+        auto const& info = *_infos[column];
+
+        if (!info.fields.empty()) {
+            for (size_t f{}; f < info.fields.size(); ++f) {
+                std::memcpy(destination.field_at(destination_column, f, destination_row), field_at(column, f, row), info.fields[f].size);
+            }
+        }
+        else if (info.trivially_relocatable) {
+            std::memcpy(destination.at(destination_column, destination_row), at(column, row), info.size);
+        }
+        else {
+            info.relocate(destination.at(destination_column, destination_row), at(column, row));
+        }
+    }
+
+    void
+    _destroy(size_t column, size_t row) noexcept {
+        if (!_infos[column]->trivially_destructible) {
+            _infos[column]->destroy(at(column, row));
+        }
+    }
+
+    // Keep one spare chunk, so rows moving back and forth at a chunk boundary do not allocate every time.
+    void
+    _release_chunks() noexcept {
+        while (_chunks.size() > chunk_count() + 1) {
+            _chunks.pop_back();
+        }
+    }
+};
+
+} // namespace vecs
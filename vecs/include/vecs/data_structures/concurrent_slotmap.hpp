@@ -0,0 +1,270 @@
+#pragma once
+
+// std
+#include <new>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <stdint.h>
+#include <stdexcept>
+#include <cassert>
+
+#include "key.hpp"
+
+namespace vecs {
+
+/*
+    Slotmap whose insert, erase and lookups can be called from many threads
+    at once without locks.
+
+    Differences with BasicSlotMap, both needed to stay lock-free:
+    - Capacity is fixed at construction, storage never moves.
+    - Elements live at their slot index, there is no dense array and no
+      swap-and-pop. Iteration (for_each) skips free slots.
+
+    Slots come from a Treiber stack freelist whose head packs a 32-bit
+    index with a 32-bit tag (bumped on every change) to avoid ABA, or,
+    when the freelist is empty, from an atomic bump of the high water mark.
+
+    Readers validate keys with an acquire load of the slot generation,
+    which pairs with the release store done once the element is built.
+    Erasing a key while another thread is still reading that same element
+    is a race, erase at a sync point or when the key has no other users.
+    for_each() and clear() are not thread-safe.
+*/
+template <typename T, typename TKey = PackedKey<uint64_t, 32>>
+class ConcurrentSlotMap {
+public:
+    using key_policy_t = vecs::key_policy_t<TKey>;
+    using index_t = typename key_policy_t::index_t;
+    using gen_t   = typename key_policy_t::gen_t;
+    using key_t   = typename key_policy_t::type;
+
+    static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t MAX_CAPACITY = std::min<size_t>(NIL, key_policy_t::MAX_SLOTS);
+
+private:
+    struct Slot {
+        std::atomic<gen_t> generation {}; // Odd = alive, see key.hpp.
+        std::atomic<uint32_t> next { NIL }; // Next free slot, only meaningful while free.
+    };
+
+    size_t _capacity{};
+    std::unique_ptr<Slot[]> _slots{};
+    T* _data{};
+
+    std::atomic<uint64_t> _freelist { NIL }; // (tag << 32) | index.
+    std::atomic<size_t> _high_water{};
+    std::atomic<size_t> _size{};
+
+public:
+    explicit ConcurrentSlotMap(size_t capacity)
+        : _capacity(_checked_capacity(capacity))
+        , _slots(std::make_unique<Slot[]>(capacity))
+        , _data(static_cast<T*>(::operator new(sizeof(T) * capacity, std::align_val_t { alignof(T) }))) {}
+
+    ConcurrentSlotMap(ConcurrentSlotMap const&) = delete;
+    ConcurrentSlotMap& operator=(ConcurrentSlotMap const&) = delete;
+
+    ~ConcurrentSlotMap() {
+        _destroy_elements();
+        ::operator delete(_data, std::align_val_t { alignof(T) });
+    }
+
+    [[nodiscard]] inline size_t size() const noexcept { return _size.load(std::memory_order_relaxed); }
+    [[nodiscard]] inline size_t capacity() const noexcept { return _capacity; }
+
+    [[nodiscard]] key_t push_back(T const& value) { return emplace_back(value); }
+    [[nodiscard]] key_t push_back(T&& value) { return emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    [[nodiscard]]
+    key_t
+    emplace_back(Args&&... args) {
+        auto const slot_id = _allocate_slot();
+        auto& slot = _slots[slot_id];
+
+        try {
+            std::construct_at(&_data[slot_id], std::forward<Args>(args)...);
+        }
+        catch (...) {
+            _push_free(slot_id);
+            throw;
+        }
+
+        // Publish: readers that see the odd generation also see the element.
+        auto const generation = _next_generation(slot.generation.load(std::memory_order_relaxed));
+        slot.generation.store(generation, std::memory_order_release);
+        _size.fetch_add(1, std::memory_order_relaxed);
+
+        return key_policy_t::make(static_cast<index_t>(slot_id), generation);
+    }
+
+    /*
+        Only one of several threads erasing the same key wins, the generation
+        is swapped from alive to free with a CAS before the element dies.
+    */
+    bool
+    erase(key_t key) {
+        auto const slot_id = key_policy_t::index(key);
+        auto expected = key_policy_t::generation(key);
+
+        if (slot_id >= _capacity || (expected & 1) == 0) {
+            return false;
+        }
+
+        auto& slot = _slots[slot_id];
+        if (!slot.generation.compare_exchange_strong(expected, _next_generation(expected), std::memory_order_acq_rel)) {
+            return false;
+        }
+
+        std::destroy_at(&_data[slot_id]);
+        _push_free(static_cast<uint32_t>(slot_id));
+        _size.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    [[nodiscard]]
+    bool
+    is_key_valid(key_t key) const noexcept {
+        auto const slot_id = key_policy_t::index(key);
+        auto const generation = key_policy_t::generation(key);
+
+        if (slot_id >= _capacity || (generation & 1) == 0) {
+            return false;
+        }
+
+        return _slots[slot_id].generation.load(std::memory_order_acquire) == generation;
+    }
+
+    // The key must be valid, use try_get() when that is not known.
+    [[nodiscard]]
+    T&
+    get(key_t key) noexcept {
+        assert(is_key_valid(key));
+        return _data[key_policy_t::index(key)];
+    }
+
+    // Returns nullptr when 'key' is stale or was never issued by this slotmap.
+    [[nodiscard]]
+    T*
+    try_get(key_t key) noexcept {
+        return is_key_valid(key) ? &_data[key_policy_t::index(key)] : nullptr;
+    }
+
+    // Not thread-safe, calls 'function' with every alive element.
+    template <typename F>
+    void
+    for_each(F&& function) {
+        auto const last = std::min(_high_water.load(std::memory_order_acquire), _capacity);
+
+        for (size_t i{}; i < last; ++i) {
+            if (_slots[i].generation.load(std::memory_order_acquire) & 1) {
+                function(_data[i]);
+            }
+        }
+    }
+
+    // Not thread-safe. Generations are kept, so old keys stay invalid.
+    void
+    clear() noexcept {
+        _destroy_elements();
+
+        auto const last = std::min(_high_water.load(std::memory_order_relaxed), _capacity);
+        for (size_t i{}; i < last; ++i) {
+            auto& generation = _slots[i].generation;
+            auto const value = generation.load(std::memory_order_relaxed);
+
+            if (value & 1) {
+                generation.store(_next_generation(value), std::memory_order_relaxed);
+            }
+        }
+
+        // Every used slot goes back through the freelist, in order.
+        _freelist.store(NIL, std::memory_order_relaxed);
+        for (size_t i { last }; i > 0; --i) {
+            _push_free(static_cast<uint32_t>(i - 1));
+        }
+
+        _size.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    [[nodiscard]]
+    static size_t
+    _checked_capacity(size_t capacity) {
+        if (capacity > MAX_CAPACITY) {
+            throw std::length_error("Failed to create slotmap: Capacity does not fit in the key index bits.");
+        }
+
+        return capacity;
+    }
+
+    [[nodiscard]]
+    uint32_t
+    _allocate_slot() {
+        auto const recycled = _pop_free();
+        if (recycled != NIL) {
+            return recycled;
+        }
+
+        // Freelist is empty, append a never used slot.
+        auto const fresh = _high_water.fetch_add(1, std::memory_order_relaxed);
+        if (fresh >= _capacity) {
+            throw std::runtime_error("Failed to add item to slotmap: No space left.");
+        }
+
+        return static_cast<uint32_t>(fresh);
+    }
+
+    [[nodiscard]]
+    uint32_t
+    _pop_free() noexcept {
+        auto head = _freelist.load(std::memory_order_acquire);
+
+        while (_index_of(head) != NIL) {
+            /*
+                 'next' may be stale if another thread pops this slot first,
+                 the tag then no longer matches and the CAS fails.
+            */
+            auto const next = _slots[_index_of(head)].next.load(std::memory_order_relaxed);
+
+            if (_freelist.compare_exchange_weak(head, _pack(next, _tag_of(head) + 1), std::memory_order_acquire, std::memory_order_acquire)) {
+                return _index_of(head);
+            }
+        }
+
+        return NIL;
+    }
+
+    void
+    _push_free(uint32_t slot_id) noexcept {
+        auto head = _freelist.load(std::memory_order_relaxed);
+
+        do {
+            _slots[slot_id].next.store(_index_of(head), std::memory_order_relaxed);
+        } while (!_freelist.compare_exchange_weak(head, _pack(slot_id, _tag_of(head) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void
+    _destroy_elements() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for_each([](T& value) { std::destroy_at(&value); });
+        }
+    }
+
+    [[nodiscard]] static constexpr uint64_t _pack(uint32_t index, uint32_t tag) noexcept { return (uint64_t { tag } << 32) | index; }
+    [[nodiscard]] static constexpr uint32_t _index_of(uint64_t head) noexcept { return static_cast<uint32_t>(head); }
+    [[nodiscard]] static constexpr uint32_t _tag_of(uint64_t head) noexcept { return static_cast<uint32_t>(head >> 32); }
+
+    [[nodiscard]]
+    static constexpr gen_t
+    _next_generation(gen_t generation) noexcept {
+        return (generation + 1) & key_policy_t::GENERATION_MASK;
+    }
+};
+
+} // namespace vecs
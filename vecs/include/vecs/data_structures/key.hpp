@@ -0,0 +1,92 @@
+#pragma once
+
+// std
+#include <limits>
+#include <concepts>
+#include <type_traits>
+#include <stdint.h>
+
+namespace vecs {
+
+/*
+    Key policies decide how a slotmap key stores its slot index and the
+    generation of that slot.
+
+    SplitKey keeps both as separate words (16 bytes with uint64_t).
+    PackedKey squeezes both into a single word, 'IndexBits' low bits for
+    the index and the remaining high bits for the generation, so a key
+    is 4 or 8 bytes and cheap to store inside components or packets.
+
+    Generations are counted per slot. They are odd while the slot is alive
+    and even while it is free, so a default constructed key (generation 0)
+    is never valid. When a generation runs out of bits it wraps around.
+*/
+
+template <std::unsigned_integral TIndex = uint64_t>
+struct SplitKey {
+    using index_t = TIndex;
+    using gen_t   = TIndex;
+
+    struct type {
+        index_t id;
+        gen_t generation;
+
+        friend constexpr bool operator==(type const&, type const&) noexcept = default;
+    };
+
+    static constexpr index_t MAX_SLOTS       = std::numeric_limits<index_t>::max();
+    static constexpr gen_t   GENERATION_MASK = std::numeric_limits<gen_t>::max();
+
+    [[nodiscard]] static constexpr type make(index_t id, gen_t generation) noexcept { return { id, generation }; }
+    [[nodiscard]] static constexpr index_t index(type key) noexcept { return key.id; }
+    [[nodiscard]] static constexpr gen_t generation(type key) noexcept { return key.generation; }
+};
+
+template <std::unsigned_integral TWord, size_t IndexBits>
+struct PackedKey {
+    static_assert(IndexBits > 0 && IndexBits + 2 <= std::numeric_limits<TWord>::digits,
+        "PackedKey needs at least 2 bits of generation.");
+
+    using index_t = TWord;
+    using gen_t   = TWord;
+
+    static constexpr size_t GENERATION_BITS = std::numeric_limits<TWord>::digits - IndexBits;
+    static constexpr index_t INDEX_MASK     = (TWord { 1 } << IndexBits) - 1;
+
+    struct type {
+        TWord value;
+
+        [[nodiscard]] constexpr index_t index() const noexcept { return value & INDEX_MASK; }
+        [[nodiscard]] constexpr gen_t generation() const noexcept { return value >> IndexBits; }
+
+        friend constexpr bool operator==(type const&, type const&) noexcept = default;
+    };
+
+    // The last index is reserved as the "one past the end" freelist link.
+    static constexpr index_t MAX_SLOTS       = INDEX_MASK;
+    static constexpr gen_t   GENERATION_MASK = std::numeric_limits<TWord>::max() >> IndexBits;
+
+    [[nodiscard]]
+    static constexpr type
+    make(index_t id, gen_t generation) noexcept {
+        return { static_cast<TWord>((generation << IndexBits) | (id & INDEX_MASK)) };
+    }
+
+    [[nodiscard]] static constexpr index_t index(type key) noexcept { return key.index(); }
+    [[nodiscard]] static constexpr gen_t generation(type key) noexcept { return key.generation(); }
+};
+
+/*
+    Lets slotmaps take either a key policy or a plain unsigned integer,
+    the latter meaning SplitKey of that integer (the original layout).
+*/
+template <typename T>
+struct key_policy { using type = T; };
+
+template <std::unsigned_integral T>
+struct key_policy<T> { using type = SplitKey<T>; };
+
+template <typename T>
+using key_policy_t = typename key_policy<T>::type;
+
+} // namespace vecs
@@ -0,0 +1,82 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <cstddef>
+
+#include "../config.hpp"
+#include "../debug.hpp"
+
+namespace vecs {
+
+/*
+    Layout policies decide how a container places its own members.
+
+    DebugLayout keeps a DebugTag in front of every member so MemoryViewer
+    dumps can be read by eye, at the cost of pushing the hot members apart.
+    ReleaseLayout drops the tags (they take no bytes), starts the object,
+    and so its hot scalars, on a cache line and aligns every array (inline
+    array or page) to a cache line too.
+
+    DefaultLayout follows the DEBUG switch in debug.hpp.
+*/
+
+// Stand-in for DebugTag that takes no room. 'Id' keeps tags distinct types so they can share addresses.
+template <size_t CharCount, size_t Id>
+struct NoTag {
+    constexpr NoTag(char const (&)[CharCount]) noexcept {}
+};
+
+struct DebugLayout {
+    template <size_t CharCount, size_t Id>
+    using tag_t = DebugTag<CharCount>;
+
+    static constexpr bool TAGGED = true;
+    static constexpr size_t HOT_ALIGNMENT = 1;
+
+    template <typename T>
+    static constexpr size_t array_alignment = alignof(T);
+};
+
+struct ReleaseLayout {
+    template <size_t CharCount, size_t Id>
+    using tag_t = NoTag<CharCount, Id>;
+
+    static constexpr bool TAGGED = false;
+    static constexpr size_t HOT_ALIGNMENT = CACHE_LINE_SIZE;
+
+    template <typename T>
+    static constexpr size_t array_alignment = std::max(alignof(T), CACHE_LINE_SIZE);
+};
+
+#ifdef DEBUG
+using DefaultLayout = DebugLayout;
+#else
+using DefaultLayout = ReleaseLayout;
+#endif
+
+/*
+    Compile-time description of where a container put its members, meant
+    for static_assert. The hot range goes from the first to the last hot
+    member (scalars and array heads touched by every operation), it is
+    packed when nothing (tags, padding) sits between them.
+*/
+struct LayoutReport {
+    size_t object_size;
+    size_t object_alignment;
+    size_t array_alignment;
+    size_t tag_bytes;
+    size_t hot_offset;
+    size_t hot_bytes;   // From the start of the first hot member to the end of the last one.
+    size_t hot_payload; // Bytes of the hot members themselves.
+
+    [[nodiscard]]
+    constexpr bool
+    hot_in_one_line() const noexcept {
+        return hot_bytes <= CACHE_LINE_SIZE && hot_offset / CACHE_LINE_SIZE == (hot_offset + hot_bytes - 1) / CACHE_LINE_SIZE;
+    }
+
+    [[nodiscard]] constexpr bool hot_is_packed() const noexcept { return hot_bytes == hot_payload; }
+};
+
+} // namespace vecs
@@ -2,95 +2,1191 @@
 
 // std
 #include <array>
+#include <tuple>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
+#include <cstring>
+#include <bit>
+#include <iterator>
 #include <stdint.h>
+#include <span>
 #include <stdexcept>
 #include <cassert>
 
+#include "key.hpp"
+#include "layout.hpp"
+#include "storage.hpp"
+#include "../config.hpp"
+#include "../debug.hpp"
+
 namespace vecs {
 
-template <typename T, size_t Capacity = 10, typename TIndex = uint64_t>
-struct SlotMap {
+namespace detail {
+
+// Index of 'T' inside the pack 'Ts', every type of the pack must be unique.
+template <typename T, typename... Ts>
+struct type_index;
+
+template <typename T, typename... Ts>
+struct type_index<T, T, Ts...> : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct type_index<T, U, Ts...> : std::integral_constant<size_t, 1 + type_index<T, Ts...>::value> {};
+
+template <typename T, typename... Ts>
+inline constexpr size_t type_index_v = type_index<std::remove_const_t<T>, Ts...>::value;
+
+struct Empty {};
+
+// Uninitialized room for one 'T', used to park an element while relocating.
+template <typename T>
+struct RawSlot {
+    alignas(T) std::byte bytes[sizeof(T)];
+
+    [[nodiscard]] T* get() noexcept { return reinterpret_cast<T*>(bytes); }
+};
+
+} // namespace detail
+
+/*
+    Order policies decide what erasing does to the dense arrays.
+
+    SwapOrder moves the last element into the hole (swap-and-pop): the
+    arrays stay packed but iteration order changes on every erase.
+    StableOrder leaves a tombstone instead and tracks alive positions in a
+    bitset, iteration skips holes a whole 64 bit word at a time. Once holes
+    exceed 'MaxHolePercent' of the dense range, the arrays are compacted
+    in order. Insertion order is never lost.
+*/
+struct SwapOrder {
+    static constexpr bool STABLE = false;
+};
+
+template <size_t MaxHolePercent = 25>
+struct StableOrder {
+    static_assert(MaxHolePercent > 0 && MaxHolePercent < 100, "MaxHolePercent must be in (0, 100).");
+
+    static constexpr bool STABLE = true;
+    static constexpr size_t MAX_HOLE_PERCENT = MaxHolePercent;
+};
+
+/*
+    Bundles every slotmap policy:
+    - 'TStorage': FixedStorage or PagedStorage, see storage.hpp.
+    - 'TKey': a key policy (see key.hpp) or a plain unsigned integer.
+    - 'TOrder': SwapOrder or StableOrder.
+    - 'TLayout': DebugLayout or ReleaseLayout, see layout.hpp.
+*/
+template <typename TStorage, typename TKey = uint64_t, typename TOrder = SwapOrder, typename TLayout = DefaultLayout>
+struct SlotMapPolicy {
+    using storage_t = TStorage;
+    using key_t     = TKey;
+    using order_t   = TOrder;
+    using layout_t  = TLayout;
+};
+
+/*
+    Forward iterator over the alive positions of a stable slotmap, it jumps
+    over holes using the bitset of alive positions. It reads the bitset and
+    the size through the slotmap, so inserting (which may grow the bitset)
+    keeps it valid.
+*/
+template <typename TBase, typename TIndex>
+class LiveIterator {
 public:
-    using index_t = TIndex;
-    using gen_t   = index_t;
-    using key_t   = struct { index_t id; gen_t generation; };
-    using iterator = T*;
-    using const_iterator = T const*;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = typename std::iterator_traits<TBase>::value_type;
+    using difference_type   = typename std::iterator_traits<TBase>::difference_type;
+    using pointer           = typename std::iterator_traits<TBase>::pointer;
+    using reference         = typename std::iterator_traits<TBase>::reference;
+
+    LiveIterator() noexcept = default;
+    LiveIterator(TBase base, std::vector<uint64_t> const* bits, TIndex const* size, size_t index) noexcept
+        : _base(base), _bits(bits), _size(size), _index(index) {
+        _skip_holes();
+    }
+
+    [[nodiscard]] reference operator*() const noexcept { return _base[_index]; }
+    [[nodiscard]] pointer operator->() const noexcept { return &_base[_index]; }
+    [[nodiscard]] size_t index() const noexcept { return _index; }
+
+    LiveIterator& operator++() noexcept { ++_index; _skip_holes(); return *this; }
+    LiveIterator operator++(int) noexcept { auto copy { *this }; ++*this; return copy; }
+
+    [[nodiscard]] friend bool operator==(LiveIterator const& a, LiveIterator const& b) noexcept { return a._index == b._index; }
 
 private:
-    // if using this header file alone, delete all debug tags (they are only for memory debugging).
-    DebugTag<8> _size_tag       { "#_size#" };
-    index_t _size{};
+    TBase _base{};
+    std::vector<uint64_t> const* _bits{};
+    TIndex const* _size{};
+    size_t _index{};
+
+    void
+    _skip_holes() noexcept {
+        size_t const end { *_size };
 
-    DebugTag<8> _freelist_tag   { "#_free#" };
+        while (_index < end) {
+            auto const word = (*_bits)[_index / 64] >> (_index % 64);
+
+            if (word != 0) {
+                _index = std::min(_index + std::countr_zero(word), end);
+                return;
+            }
+
+            _index = (_index / 64 + 1) * 64; // Next word.
+        }
+
+        _index = end;
+    }
+};
+
+/*
+    'Ts' are the columns of the slotmap. Every column is a separate dense
+    array (SoA), all of them are driven by the same indices table and
+    freelist, so one key addresses one element of every column.
+
+    'TPolicy' is a SlotMapPolicy.
+*/
+template <typename TPolicy, typename... Ts>
+struct BasicSlotMap {
+    static_assert(sizeof...(Ts) > 0, "A slotmap needs at least one column.");
+
+    using TStorage = typename TPolicy::storage_t;
+    using TOrder   = typename TPolicy::order_t;
+    using TLayout  = typename TPolicy::layout_t;
+
+    template <size_t CharCount, size_t Id>
+    using tag_t = typename TLayout::template tag_t<CharCount, Id>;
+
+public:
+    using key_policy_t = vecs::key_policy_t<typename TPolicy::key_t>;
+    using index_t = typename key_policy_t::index_t;
+    using gen_t   = typename key_policy_t::gen_t;
+    using key_t   = typename key_policy_t::type;
+    using value_type = std::tuple_element_t<0, std::tuple<Ts...>>;
+
+    template <typename U>
+    using array_t = typename TStorage::template array_t<U, TLayout::template array_alignment<U>>;
+
+    static constexpr bool GROWABLE = array_t<value_type>::GROWABLE;
+    static constexpr bool STABLE = TOrder::STABLE;
+
+    template <typename TBase>
+    using iterator_t = std::conditional_t<STABLE, LiveIterator<TBase, index_t>, TBase>;
+    using iterator = iterator_t<typename array_t<value_type>::iterator>;
+    using const_iterator = iterator_t<typename array_t<value_type>::const_iterator>;
+    static constexpr size_t COLUMN_COUNT = sizeof...(Ts);
+
+    // How many keys ahead gather() issues its prefetches.
+    static constexpr size_t GATHER_DISTANCE = 8;
+
+    template <typename U>
+    static constexpr size_t column_index = detail::type_index_v<U, Ts...>;
+
+    template <size_t I>
+    using column_t = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    /*
+        Plain [begin, end) view over one column, it only touches the bytes
+        of that column.
+    */
+    template <typename U>
+    struct Column {
+        iterator_t<typename array_t<std::remove_const_t<U>>::iterator> first;
+        iterator_t<typename array_t<std::remove_const_t<U>>::iterator> last;
+        size_t count;
+
+        [[nodiscard]] auto begin() const noexcept { return first; }
+        [[nodiscard]] auto end() const noexcept { return last; }
+        [[nodiscard]] size_t size() const noexcept { return count; }
+    };
+
+private:
+    /*
+        Debug tags only take room with DebugLayout, see layout.hpp. Hot
+        members come first: the scalars, then the indices and erase array
+        heads (for paged storage, the page vectors), then the columns.
+    */
+    VECS_NO_UNIQUE_ADDRESS tag_t<8, 0> _size_tag       { "#_size#" };
+    alignas(std::max(alignof(index_t), TLayout::HOT_ALIGNMENT)) index_t _size{};
+
+    VECS_NO_UNIQUE_ADDRESS tag_t<8, 1> _freelist_tag   { "#_free#" };
     index_t _freelist{};
 
-    DebugTag<8> _generation_tag { "#_gene#" };
-    gen_t _generation{};
+    /*
+        A slot stores, while alive, the position of its element in the dense
+        arrays and, while free, the next free slot. The generation is per
+        slot (odd = alive), see key.hpp.
+    */
+    struct Slot { index_t id; gen_t generation; };
+
+    /*
+        Arrays are raw storage (see storage.hpp), only [0, _size) of the
+        dense arrays hold constructed elements.
+    */
+    VECS_NO_UNIQUE_ADDRESS tag_t<16, 2> _indices_tag    { "#_indices#slot#" };
+    array_t<Slot> _indices;
 
-    DebugTag<16> _indices_tag    { "#_indices#keys#" };
-    std::array<key_t, Capacity> _indices{}; // keys
+    VECS_NO_UNIQUE_ADDRESS tag_t<16, 3> _erase_tag      { "#_erase########" };
+    array_t<index_t> _erase;
 
-    DebugTag<16> _data_tag       { "#_data#########" };
-    std::array<T, Capacity> _data{};
+    VECS_NO_UNIQUE_ADDRESS tag_t<16, 4> _data_tag       { "#_data#########" };
+    std::tuple<array_t<Ts>...> _data; // One dense array per column.
 
-    DebugTag<16> _erase_tag      { "#_erase########" };
-    std::array<index_t, Capacity> _erase{};
+    /*
+        Stable order only: how many holes [0, _size) has and one bit per
+        dense position, set while the position holds an element. Bits past
+        _size are always clear.
+    */
+    struct LiveSet {
+        index_t holes{};
+        std::vector<uint64_t> bits{};
+    };
+
+    VECS_NO_UNIQUE_ADDRESS std::conditional_t<STABLE, LiveSet, detail::Empty> _live{};
+
+    /*
+        State of the sort_step() in progress: a bottom-up merge sort over
+        the slots of the elements, then a pass moving them into place.
+        Entries keep the generation of their slot, an erased (or erased and
+        reused) slot no longer matches it. 'width' is the run length of the
+        current pass, 0 when no sort is running. The runs being merged start
+        at 'begin' and 'begin + width', 'left' and 'right' are the next entry
+        of each. Once merged, 'next' is the entry to move to 'placed'.
+    */
+    struct SortEntry { index_t slot; gen_t generation; };
+
+    struct SortState {
+        std::vector<SortEntry> order{};
+        std::vector<SortEntry> merged{};
+        size_t width{};
+        size_t begin{};
+        size_t left{};
+        size_t right{};
+        size_t next{};
+        index_t placed{};
+    };
+
+    SortState _sort_state{};
 
 public:
-    constexpr explicit SlotMap() {
-        clear();
+    explicit BasicSlotMap() {
+        if constexpr (!GROWABLE) {
+            static_assert(array_t<Slot>::CAPACITY <= key_policy_t::MAX_SLOTS, "Capacity does not fit in the key index bits.");
+            _init_slots(0);
+        }
     }
 
-    [[nodiscard]] inline constexpr size_t size() const noexcept { return _size; }
-    [[nodiscard]] inline constexpr size_t capacity() const noexcept { return Capacity; }
-    [[nodiscard]] constexpr iterator begin() noexcept { return _data.begin(); }
-    [[nodiscard]] constexpr iterator   end() noexcept { return _data.begin() + _size; }
-    [[nodiscard]] constexpr const_iterator cbegin() const noexcept { return _data.cbegin(); }
-    [[nodiscard]] constexpr const_iterator   cend() const noexcept { return _data.cbegin() + _size; }
+    BasicSlotMap(BasicSlotMap const& other) : BasicSlotMap() {
+        if constexpr (GROWABLE) {
+            _reserve_slots(other.capacity());
+            _reserve_data(other._size);
+        }
+
+        for (index_t i{}; i < other.capacity(); ++i) {
+            _indices[i] = other._indices[i];
+        }
 
-    [[nodiscard]] constexpr key_t push_back(T const& value) { return push_back(T { value }); };
-    [[nodiscard]] constexpr key_t push_back(T&& value) {
-        index_t reserved_slot_id = _allocate_slot();
-        auto& slot = _indices[reserved_slot_id];
+        if constexpr (STABLE) {
+            _live.bits.resize(other._live.bits.size());
+        }
 
-        // Move data.
-        _data[slot.id] = std::move(value); // Move is like "cast to rvalue" (at low level is not that).
-        _erase[slot.id] = reserved_slot_id;
+        for (index_t i{}; i < other._size; ++i) {
+            if (other._is_live(i)) {
+                (std::construct_at(&_column<column_index<Ts>>()[i], other._column<column_index<Ts>>()[i]), ...);
+                _mark_live(i);
+            }
+            else if constexpr (STABLE) {
+                ++_live.holes;
+            }
+
+            _erase[i] = other._erase[i];
+            ++_size; // Counted one by one, a throwing copy leaves a valid map behind.
+        }
+
+        _freelist = other._freelist;
+    }
+
+    BasicSlotMap(BasicSlotMap&& other) noexcept : BasicSlotMap() {
+        if constexpr (GROWABLE) {
+            // Pages change owner, no element moves.
+            _indices = std::move(other._indices);
+            _data    = std::move(other._data);
+            _erase   = std::move(other._erase);
+        }
+        else {
+            for (index_t i{}; i < other.capacity(); ++i) {
+                _indices[i] = other._indices[i];
+            }
+
+            other._for_each_live([&](index_t i) {
+                (_relocate(&_column<column_index<Ts>>()[i], &other._column<column_index<Ts>>()[i]), ...);
+            });
+
+            for (index_t i{}; i < other._size; ++i) {
+                _erase[i] = other._erase[i];
+            }
+        }
+
+        _size = other._size;
+        _freelist = other._freelist;
+        _live = std::move(other._live);
+
+        // Elements were relocated, 'other' must not destroy them again.
+        other._size = 0;
+        other._live = {};
+        other.clear();
+    }
+
+    BasicSlotMap&
+    operator=(BasicSlotMap const& other) {
+        if (this != &other) {
+            *this = BasicSlotMap { other };
+        }
+
+        return *this;
+    }
+
+    BasicSlotMap&
+    operator=(BasicSlotMap&& other) noexcept {
+        if (this != &other) {
+            this->~BasicSlotMap();
+            std::construct_at(this, std::move(other));
+        }
+
+        return *this;
+    }
+
+    ~BasicSlotMap() {
+        _destroy_elements();
+    }
+
+    [[nodiscard]] inline constexpr size_t size() const noexcept { return _size - _hole_count(); }
+    [[nodiscard]] inline constexpr size_t capacity() const noexcept { return _indices.capacity(); }
+    [[nodiscard]] iterator begin() noexcept requires (COLUMN_COUNT == 1) { return _iterator_at(_column<0>().begin(), 0); }
+    [[nodiscard]] iterator   end() noexcept requires (COLUMN_COUNT == 1) { return _iterator_at(_column<0>().begin(), _size); }
+    [[nodiscard]] const_iterator cbegin() const noexcept requires (COLUMN_COUNT == 1) { return _iterator_at(_column<0>().begin(), 0); }
+    [[nodiscard]] const_iterator   cend() const noexcept requires (COLUMN_COUNT == 1) { return _iterator_at(_column<0>().begin(), _size); }
+
+    template <typename U>
+    [[nodiscard]]
+    Column<U>
+    column() noexcept {
+        auto const base = _column<column_index<U>>().begin();
+        return { _iterator_at(base, 0), _iterator_at(base, _size), size() };
+    }
+
+    [[nodiscard]] key_t push_back(Ts const&... values) { return _insert(values...); };
+    [[nodiscard]] key_t push_back(Ts&&... values) { return _insert(std::move(values)...); }
+
+    // Single column only. Constructs the element in place from 'args'.
+    template <typename... Args>
+    [[nodiscard]]
+    key_t
+    emplace_back(Args&&... args) requires (COLUMN_COUNT == 1) {
+        return _insert(std::forward<Args>(args)...);
+    }
+
+    /*
+        Inserts 'out.size()' elements, element 'i' being built from
+        'values[i]...' (one span per column), and writes their keys to 'out'.
+        Capacity is secured once for the whole run and the elements land in
+        the contiguous dense range [size(), size() + count), trivially
+        copyable columns are copied page by page with memcpy.
+    */
+    void
+    push_back_range(std::span<key_t> out, std::span<Ts const>... values) {
+        assert(((values.size() == out.size()) && ...));
+
+        auto const first = _reserve_run(out.size());
+
+        if constexpr ((std::is_trivially_copyable_v<Ts> && ...)) {
+            _for_each_range(first, first + out.size(), [&](size_t begin, size_t count) {
+                (std::memcpy(
+                    static_cast<void*>(&_column<column_index<Ts>>()[begin]),
+                    values.data() + (begin - first),
+                    count * sizeof(Ts)
+                ), ...);
+            });
+        }
+        else {
+            _construct_run(first, out.size(), [&](size_t i, size_t at) {
+                _construct_columns(std::index_sequence_for<Ts...>{}, at, values[i]...);
+            });
+        }
+
+        _link_run(first, out);
+    }
+
+    /*
+        Inserts 'out.size()' elements, each one built from 'args' (a single
+        column built from all 'args', or one argument per column), and
+        writes their keys to 'out'.
+    */
+    template <typename... Args>
+    void
+    emplace_n(std::span<key_t> out, Args const&... args) {
+        auto const first = _reserve_run(out.size());
 
-        // Copy slot and generate key for user.
-        key_t key { slot };
-        key.id = reserved_slot_id;
+        _construct_run(first, out.size(), [&](size_t, size_t at) {
+            if constexpr (COLUMN_COUNT == 1) {
+                std::construct_at(&_column<0>()[at], args...);
+            }
+            else {
+                _construct_columns(std::index_sequence_for<Ts...>{}, at, args...);
+            }
+        });
 
-        return key;
+        _link_run(first, out);
     }
 
-    constexpr bool
+    bool
     erase(key_t key) noexcept {
         if (!is_key_valid(key)) {
             return false;
         }
 
         _free_slot(key);
-        return true; 
+        return true;
+    }
+
+    /*
+        Erases every valid key of 'keys' (invalid and repeated keys are
+        skipped) and returns how many elements were erased.
+
+        Instead of one swap-and-pop per key, the holes are collected and
+        filled in a single pass with the survivors at the tail of the dense
+        arrays, so each survivor moves at most once.
+    */
+    size_t
+    erase_batch(std::span<key_t const> keys) {
+        std::vector<index_t> holes{};
+        holes.reserve(keys.size());
+
+        for (auto key: keys) {
+            if (!is_key_valid(key)) {
+                continue;
+            }
+
+            auto const slot_id = key_policy_t::index(key);
+            auto const data_id = _indices[slot_id].id;
+
+            (std::destroy_at(&_column<column_index<Ts>>()[data_id]), ...);
+            _link_free_slot(slot_id);
+            holes.push_back(data_id);
+        }
+
+        if constexpr (STABLE) {
+            _leave_holes(holes);
+        }
+        else {
+            std::sort(holes.begin(), holes.end());
+            _fill_holes(holes);
+        }
+
+        return holes.size();
+    }
+
+    /*
+        Erases every element for which 'predicate' (called with a reference
+        to each column) returns true. Returns how many were erased.
+    */
+    template <typename F>
+    size_t
+    erase_if(F&& predicate) {
+        std::vector<index_t> holes{};
+
+        _for_each_live([&](index_t i) {
+            if (!predicate(std::as_const(_column<column_index<Ts>>()[i])...)) {
+                return;
+            }
+
+            (std::destroy_at(&_column<column_index<Ts>>()[i]), ...);
+            _link_free_slot(_erase[i]);
+            holes.push_back(i); // Sorted already.
+        });
+
+        if constexpr (STABLE) {
+            _leave_holes(holes);
+        }
+        else {
+            _fill_holes(holes);
+        }
+
+        return holes.size();
     }
 
     [[nodiscard]]
-    constexpr bool 
+    bool
     is_key_valid(key_t key) const noexcept {
-        if (key.id >= Capacity || key.generation != _indices[key.id].generation) {
+        auto const id = key_policy_t::index(key);
+
+        if (id >= _indices.capacity()) {
             return false;
         }
 
+        // Free slots have an even generation, so keys into them never match.
+        auto const& slot = _indices[id];
+        return _is_alive(slot) && key_policy_t::generation(key) == slot.generation;
+    }
+
+    // Key of the element living in slot 'id', a default (never valid) key when the slot is free.
+    [[nodiscard]]
+    key_t
+    key_of_slot(index_t id) const noexcept {
+        if (id >= _indices.capacity() || !_is_alive(_indices[id])) {
+            return {};
+        }
+
+        return key_policy_t::make(id, _indices[id].generation);
+    }
+
+    /*
+        Returns the element of column 'U' addressed by 'key'. The key must be
+        valid, use try_get() when that is not known.
+    */
+    template <typename U = value_type>
+    [[nodiscard]]
+    U&
+    get(key_t key) noexcept {
+        assert(is_key_valid(key));
+        return _column<column_index<U>>()[_indices[key_policy_t::index(key)].id];
+    }
+
+    template <typename U = value_type>
+    [[nodiscard]]
+    U const&
+    get(key_t key) const noexcept {
+        assert(is_key_valid(key));
+        return _column<column_index<U>>()[_indices[key_policy_t::index(key)].id];
+    }
+
+    // Returns nullptr when 'key' is stale or was never issued by this slotmap.
+    template <typename U = value_type>
+    [[nodiscard]]
+    U*
+    try_get(key_t key) noexcept {
+        if (!is_key_valid(key)) {
+            return nullptr;
+        }
+
+        return &_column<column_index<U>>()[_indices[key_policy_t::index(key)].id];
+    }
+
+    template <typename U = value_type>
+    [[nodiscard]]
+    U const*
+    try_get(key_t key) const noexcept {
+        return const_cast<BasicSlotMap*>(this)->template try_get<U>(key);
+    }
+
+    /*
+        Resolves every key of 'keys' into 'out' (nullptr for invalid keys) and
+        returns how many were valid.
+
+        Resolving a key takes two dependent loads: _indices[key.id] and then
+        the data slot it points to. Doing it one key at a time stalls on both
+        misses, so the loop runs two prefetch fronts ahead of the resolve:
+        'GATHER_DISTANCE * 2' keys ahead it prefetches the indices entry, and
+        'GATHER_DISTANCE' keys ahead (when that entry should be in cache) it
+        reads it and prefetches the data slot.
+    */
+    template <typename U = value_type>
+    size_t
+    gather(std::span<key_t const> keys, std::span<U*> out) noexcept {
+        assert(out.size() >= keys.size());
+
+        auto& column = _column<column_index<U>>();
+        auto const count = keys.size();
+        size_t valid{};
+
+        auto prefetch_slot = [&](size_t i) {
+            auto const id = key_policy_t::index(keys[i]);
+
+            if (id < _indices.capacity()) {
+                VECS_PREFETCH(&_indices[id]);
+            }
+        };
+
+        auto prefetch_data = [&](size_t i) {
+            auto const id = key_policy_t::index(keys[i]);
+
+            if (id < _indices.capacity()) {
+                auto const data_id = _indices[id].id;
+
+                if (data_id < _size) { // Free slots store freelist links, not data ids.
+                    VECS_PREFETCH(&column[data_id]);
+                }
+            }
+        };
+
+        for (size_t i{}; i < std::min(count, GATHER_DISTANCE * 2); ++i) {
+            prefetch_slot(i);
+        }
+
+        for (size_t i{}; i < std::min(count, GATHER_DISTANCE); ++i) {
+            prefetch_data(i);
+        }
+
+        for (size_t i{}; i < count; ++i) {
+            if (i + GATHER_DISTANCE * 2 < count) {
+                prefetch_slot(i + GATHER_DISTANCE * 2);
+            }
+
+            if (i + GATHER_DISTANCE < count) {
+                prefetch_data(i + GATHER_DISTANCE);
+            }
+
+            out[i] = try_get<U>(keys[i]);
+            valid += (out[i] != nullptr);
+        }
+
+        return valid;
+    }
+
+    /*
+        Destroys every element and frees every slot. Generations are kept
+        (live slots are bumped to free), so keys issued before clear() stay
+        invalid afterwards.
+    */
+    void
+    clear() noexcept {
+        _destroy_elements();
+
+        for (index_t i{}; i < _indices.capacity(); ++i) {
+            if (_is_alive(_indices[i])) {
+                _indices[i].generation = _next_generation(_indices[i].generation);
+            }
+        }
+
+        _size = 0;
+        _init_freelist();
+        _sort_state.width = 0;
+
+        if constexpr (STABLE) {
+            _live.holes = 0;
+            std::fill(_live.bits.begin(), _live.bits.end(), 0);
+        }
+    }
+
+    /*
+        Stable order only. Moves every element down over the holes, keeping
+        their order, and patches the indices table. Happens on its own once
+        holes pass the policy threshold.
+    */
+    void
+    compact() noexcept requires STABLE {
+        index_t write{};
+        index_t placed{}; // Where sort_step() resumes once the holes are gone.
+
+        _for_each_live([&](index_t read) {
+            if (read < _sort_state.placed) {
+                placed = write + 1;
+            }
+
+            if (read != write) {
+                (_relocate(&_column<column_index<Ts>>()[write], &_column<column_index<Ts>>()[read]), ...);
+                _erase[write] = _erase[read];
+                _indices[_erase[write]].id = write;
+            }
+
+            ++write;
+        });
+
+        std::fill(_live.bits.begin(), _live.bits.end(), 0);
+        for (index_t i{}; i < write; ++i) {
+            _mark_live(i);
+        }
+
+        _size = write;
+        _live.holes = 0;
+        _sort_state.placed = placed;
+        _release_data_pages();
+    }
+
+    /*
+        Moves elements around so that position 'i' of the dense arrays ends
+        up holding the element found at 'order[i]' before the call (every
+        column moves in lockstep). 'order' must be a permutation of
+        [0, size()). Keys stay valid: only the dense ids stored in the
+        indices table change.
+
+        Stable order compacts first, so positions are counted without holes.
+        Drops a sort_step() in progress.
+    */
+    void
+    reorder(std::span<index_t const> order) {
+        if (order.size() != size()) {
+            throw std::invalid_argument("Failed to reorder slotmap: Permutation size does not match the slotmap size.");
+        }
+
+        if constexpr (STABLE) {
+            if (_live.holes > 0) {
+                compact();
+            }
+        }
+
+        _sort_state.width = 0;
+        std::vector<index_t> pending(order.begin(), order.end());
+
+        // Follow every cycle once, parking the first element of each.
+        for (index_t start{}; start < _size; ++start) {
+            if (pending[start] == start) {
+                continue;
+            }
+
+            std::tuple<detail::RawSlot<Ts>...> parked{};
+            (_relocate(std::get<detail::RawSlot<Ts>>(parked).get(), &_column<column_index<Ts>>()[start]), ...);
+            auto const parked_slot = _erase[start];
+
+            index_t hole { start };
+            while (pending[hole] != start) {
+                auto const source = pending[hole];
+                assert(source < _size && pending[source] != source && "order is not a permutation");
+
+                (_relocate(&_column<column_index<Ts>>()[hole], &_column<column_index<Ts>>()[source]), ...);
+                _erase[hole] = _erase[source];
+                pending[hole] = hole;
+                hole = source;
+            }
+
+            (_relocate(&_column<column_index<Ts>>()[hole], std::get<detail::RawSlot<Ts>>(parked).get()), ...);
+            _erase[hole] = parked_slot;
+            pending[hole] = hole;
+        }
+
+        for (index_t i{}; i < _size; ++i) {
+            _indices[_erase[i]].id = i;
+        }
+    }
+
+    /*
+        Sorts the dense arrays by column 'U' with 'compare(U const&, U const&)',
+        e.g. by the order systems walk them, to get locality back after heavy
+        churn. Sorting happens on an index permutation first, then every
+        column is moved once, see reorder().
+    */
+    template <typename U = value_type, typename F>
+    void
+    sort(F&& compare) {
+        auto const& column = _column<column_index<U>>();
+        std::vector<index_t> order(size());
+
+        if constexpr (STABLE) {
+            index_t next{};
+            _for_each_live([&](index_t i) { order[next++] = i; });
+        }
+        else {
+            for (index_t i{}; i < _size; ++i) {
+                order[i] = i;
+            }
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&](index_t a, index_t b) { return compare(column[a], column[b]); });
+
+        if constexpr (STABLE) {
+            /*
+                'order' holds positions before compaction, compaction keeps
+                the relative order, so rank them to positions after it.
+            */
+            std::vector<index_t> rank(_size);
+            index_t next{};
+            _for_each_live([&](index_t i) { rank[i] = next++; });
+
+            for (auto& position: order) {
+                position = rank[position];
+            }
+        }
+
+        reorder(order);
+    }
+
+    /*
+        Incremental sort for spreading the cost over many frames: a bottom-up
+        merge sort of the element slots, O(n log n) comparisons in total,
+        then a pass swapping every element into place. A call does at most
+        'budget' merge or placement steps (one comparison or one swap each) and
+        the next one resumes there, the call that finishes returns true.
+        Inserting or erasing in between is fine: erased elements are
+        dropped and new ones stay after the sorted ones. Erasing an element
+        already swapped into place still moves the last one into its hole
+        unless the map keeps a stable order.
+    */
+    template <typename U = value_type, typename F>
+    bool
+    sort_step(F&& compare, size_t budget) {
+        auto& state = _sort_state;
+        if (state.width == 0) {
+            state.order.clear();
+            _for_each_live([&](index_t i) { state.order.push_back({ _erase[i], _indices[_erase[i]].generation }); });
+            state.merged.resize(state.order.size());
+
+            state.width = 1;
+            state.begin = state.left = state.next = 0;
+            state.right = std::min<size_t>(1, state.order.size());
+            state.placed = 0;
+        }
+
+        auto const& column = _column<column_index<U>>();
+        auto const count = state.order.size();
+
+        auto const erased = [&](SortEntry entry) { return _indices[entry.slot].generation != entry.generation; };
+        auto const less = [&](SortEntry a, SortEntry b) {
+            return compare(column[_indices[a.slot].id], column[_indices[b.slot].id]);
+        };
+
+        /*
+            Erased entries go out first without a comparison, the elements
+            left in both runs are still sorted so the merge stays correct.
+        */
+        while (state.width < count) {
+            if (budget == 0) {
+                return false;
+            }
+
+            auto const mid = std::min(state.begin + state.width, count);
+            auto const end = std::min(state.begin + 2 * state.width, count);
+            auto const out = state.left + state.right - mid;
+
+            bool take_left {};
+            if (state.left < mid && state.right < end) {
+                auto const left = state.order[state.left];
+                auto const right = state.order[state.right];
+                take_left = erased(left) || (!erased(right) && !less(right, left));
+            }
+            else if (state.left < mid || state.right < end) {
+                take_left = state.left < mid;
+            }
+            else {
+                // Both runs are merged, on to the next pair or the next pass.
+                state.begin = end;
+                if (state.begin == count) {
+                    std::swap(state.order, state.merged);
+                    state.width *= 2;
+                    state.begin = 0;
+                }
+
+                state.left = state.begin;
+                state.right = std::min(state.begin + state.width, count);
+                continue;
+            }
+
+            state.merged[out] = take_left ? state.order[state.left++] : state.order[state.right++];
+            --budget;
+        }
+
+        // Positions below 'placed' hold sorted elements, holes and what erasing moved there.
+        while (state.next < count) {
+            if (budget == 0) {
+                return false;
+            }
+
+            auto const entry = state.order[state.next++];
+            --budget;
+
+            if (erased(entry)) {
+                continue;
+            }
+
+            auto const position = _indices[entry.slot].id;
+            if (position < state.placed) {
+                continue; // Moved into the sorted part by an erase, stays there.
+            }
+
+            while (!_is_live(state.placed)) {
+                ++state.placed;
+            }
+
+            if (position != state.placed) {
+                _swap_positions(position, state.placed);
+            }
+
+            ++state.placed;
+        }
+
+        state.width = 0;
         return true;
     }
 
-    constexpr void clear() noexcept { _init_freelist(); }
+    /*
+        Calls 'function' with one reference per requested column for every
+        element, columns that are not requested are never read. Growable
+        storage is walked page by page so the inner loop stays a plain
+        pointer increment.
+    */
+    template <typename... Us, typename F>
+    void
+    each(F&& function) {
+        if constexpr (STABLE) {
+            _for_each_live([&](index_t i) { function(_column<column_index<Us>>()[i]...); });
+            return;
+        }
+
+        _for_each_range([&](size_t first, size_t count) {
+            auto columns = std::tuple { &_column<column_index<Us>>()[first]... };
+
+            for (size_t i{}; i < count; ++i) {
+                std::apply([&](auto*... column) { function(column[i]...); }, columns);
+            }
+        });
+    }
+
+    /*
+        Swap order only. Calls 'function' with one span per requested
+        column ('Us' may be const) for every contiguous run of elements:
+        the whole dense range for inline storage, one run per page for
+        growable storage. Inner loops over the spans are plain array loops
+        the compiler can vectorize.
+    */
+    template <typename... Us, typename F>
+    void
+    each_chunk(F&& function) requires (!STABLE) {
+        _for_each_range([&](size_t first, size_t count) {
+            function(std::span<Us> { &_column<column_index<std::remove_const_t<Us>>>()[first], count }...);
+        });
+    }
+
+    /*
+        Growable storage only. Allocates pages until 'count' elements fit
+        without further allocations.
+    */
+    void
+    reserve(size_t count) requires GROWABLE {
+        _reserve_slots(count);
+        _reserve_data(count);
+    }
+
+    /*
+        Growable storage only. Returns every data page that holds no element
+        back to the allocator. The indices table is kept, since its slots
+        may still be referenced by keys or by the freelist.
+    */
+    void
+    shrink_to_fit() noexcept requires GROWABLE {
+        while (_erase.page_count() > _pages_needed(_size)) {
+            _pop_data_page();
+        }
+    }
+
+    /*
+        Where this instantiation put its members, see LayoutReport. The hot
+        range is _size and _freelist, plus the indices and erase array heads
+        when those are page vectors (inline arrays are data, not heads).
+    */
+    [[nodiscard]]
+    static constexpr LayoutReport
+    layout_report() noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+        constexpr size_t hot_first = offsetof(BasicSlotMap, _size);
+        constexpr size_t hot_last = GROWABLE
+            ? offsetof(BasicSlotMap, _erase) + sizeof(array_t<index_t>)
+            : offsetof(BasicSlotMap, _freelist) + sizeof(index_t);
+#if defined(__GNUC__) || defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+        constexpr size_t hot_payload = sizeof(index_t) * 2 + (GROWABLE ? sizeof(array_t<Slot>) + sizeof(array_t<index_t>) : 0);
+        constexpr size_t tag_bytes = TLayout::TAGGED ? sizeof(tag_t<8, 0>) * 2 + sizeof(tag_t<16, 0>) * 3 : 0;
+
+        return {
+            .object_size      = sizeof(BasicSlotMap),
+            .object_alignment = alignof(BasicSlotMap),
+            .array_alignment  = TLayout::template array_alignment<value_type>,
+            .tag_bytes        = tag_bytes,
+            .hot_offset       = hot_first,
+            .hot_bytes        = hot_last - hot_first,
+            .hot_payload      = hot_payload,
+        };
+    }
 
 private:
-    constexpr void
+    template <typename... Args>
+    [[nodiscard]]
+    key_t
+    _insert(Args&&... args) {
+        _reserve_live(_size + 1);
+        index_t reserved_slot_id = _allocate_slot();
+        auto& slot = _indices[reserved_slot_id];
+
+        try {
+            if constexpr (COLUMN_COUNT == 1) {
+                std::construct_at(&_column<0>()[slot.id], std::forward<Args>(args)...);
+            }
+            else {
+                // One value per column.
+                _construct_columns(std::index_sequence_for<Ts...>{}, slot.id, std::forward<Args>(args)...);
+            }
+        }
+        catch (...) {
+            _release_slot(reserved_slot_id);
+            throw;
+        }
+
+        _erase[slot.id] = reserved_slot_id;
+        _mark_live(slot.id);
+
+        // Generate key for user.
+        return key_policy_t::make(reserved_slot_id, slot.generation);
+    }
+
+    // If a column throws, the columns constructed before it are destroyed.
+    template <size_t... Is, typename... Args>
+    void
+    _construct_columns(std::index_sequence<Is...>, index_t at, Args&&... args) {
+        size_t constructed{};
+
+        try {
+            ((std::construct_at(&_column<Is>()[at], std::forward<Args>(args)), ++constructed), ...);
+        }
+        catch (...) {
+            ((Is < constructed ? std::destroy_at(&_column<Is>()[at]) : void()), ...);
+            throw;
+        }
+    }
+
+    /*
+        Makes room for 'count' more elements and returns where the run starts
+        in the dense arrays. Nothing is linked yet, see _link_run().
+    */
+    [[nodiscard]]
+    index_t
+    _reserve_run(size_t count) {
+        if constexpr (GROWABLE) {
+            _reserve_slots(_size + count);
+            _reserve_data(_size + count);
+        }
+        else if (_size + count > capacity()) {
+            throw std::runtime_error("Failed to add items to slotmap: No space left.");
+        }
+
+        _reserve_live(_size + count);
+
+        return _size;
+    }
+
+    // Constructs [first, first + count), on failure destroys what was built.
+    template <typename F>
+    void
+    _construct_run(index_t first, size_t count, F&& construct) {
+        size_t constructed{};
+
+        try {
+            for (; constructed < count; ++constructed) {
+                construct(constructed, first + constructed);
+            }
+        }
+        catch (...) {
+            for (size_t i{}; i < constructed; ++i) {
+                (std::destroy_at(&_column<column_index<Ts>>()[first + i]), ...);
+            }
+
+            throw;
+        }
+    }
+
+    // Pops one slot per element of the constructed run [first, first + keys.size()).
+    void
+    _link_run(index_t first, std::span<key_t> keys) noexcept {
+        for (size_t i{}; i < keys.size(); ++i) {
+            index_t slot_id = _freelist;
+            auto& slot = _indices[slot_id];
+            _freelist = slot.id;
+
+            slot.id = first + i;
+            slot.generation = _next_generation(slot.generation);
+            _erase[first + i] = slot_id;
+            _mark_live(first + i);
+
+            keys[i] = key_policy_t::make(slot_id, slot.generation);
+        }
+
+        _size += keys.size();
+    }
+
+    /*
+        'holes' are sorted dense positions whose elements are destroyed and
+        whose slots are already free. Each hole below the new size gets the
+        last surviving element, then the size shrinks by the hole count.
+    */
+    void
+    _fill_holes(std::span<index_t const> holes) noexcept {
+        auto const new_size = static_cast<index_t>(_size - holes.size());
+        size_t front{};
+        size_t back { holes.size() };
+        index_t last = _size - 1;
+
+        while (front < back && holes[front] < new_size) {
+            // Skip the tail positions that are holes themselves.
+            while (holes[back - 1] == last) {
+                --back;
+                --last;
+            }
+
+            auto const hole = holes[front];
+            (_relocate(&_column<column_index<Ts>>()[hole], &_column<column_index<Ts>>()[last]), ...);
+            _erase[hole] = _erase[last];
+            _indices[_erase[hole]].id = hole;
+
+            ++front;
+            --last;
+        }
+
+        _size = new_size;
+        _release_data_pages();
+    }
+
+    /*
+        Stable order: 'holes' (any order) are destroyed, free positions that
+        stay where they are. Trailing holes are trimmed off the dense range
+        and the arrays are compacted once holes pass the threshold.
+    */
+    void
+    _leave_holes(std::span<index_t const> holes) noexcept requires STABLE {
+        for (auto hole: holes) {
+            _live.bits[hole / 64] &= ~(uint64_t { 1 } << (hole % 64));
+        }
+
+        _live.holes += static_cast<index_t>(holes.size());
+
+        while (_size > 0 && !_is_live(_size - 1)) {
+            --_size;
+            --_live.holes;
+        }
+
+        if (_live.holes * 100 > _size * TOrder::MAX_HOLE_PERCENT) {
+            compact();
+        }
+        else {
+            _release_data_pages();
+        }
+    }
+
+    // Keep one spare page as hysteresis, see _free_slot().
+    void
+    _release_data_pages() noexcept {
+        if constexpr (GROWABLE) {
+            while (_erase.page_count() > _pages_needed(_size) + 1) {
+                _pop_data_page();
+            }
+        }
+    }
+
+    // Writes a fresh freelist over the slots [first, capacity).
+    void
+    _init_slots(index_t first) noexcept {
+        for (index_t i { first }; i < _indices.capacity(); ++i) {
+            _indices[i] = { i + 1, 0 }; // Store next free index.
+        }
+    }
+
+    void
     _init_freelist() noexcept {
-        for (index_t i{}; i < _indices.size(); ++i) {
+        for (index_t i{}; i < _indices.capacity(); ++i) {
             _indices[i].id = i + 1; // Store next free index.
         }
 
@@ -98,53 +1194,347 @@ private:
     }
 
     [[nodiscard]]
-    constexpr index_t
+    index_t
     _allocate_slot() {
-        if (_size >= Capacity) {
+        if constexpr (GROWABLE) {
+            /*
+                The freelist always ends pointing one past the last slot,
+                which is exactly the first slot of the next page. Adding a
+                page extends the freelist with no extra bookkeeping.
+            */
+            if (_freelist == _indices.capacity()) {
+                _add_indices_page();
+            }
+
+            if (_size == _erase.capacity()) {
+                _add_data_page();
+            }
+        }
+        else if (_size >= capacity()) {
             throw std::runtime_error("Failed to add item to slotmap: No space left.");
         }
 
-        assert(_freelist < Capacity);
+        assert(_freelist < capacity());
 
         // Reserve slot.
         index_t slot_id = _freelist;
         _freelist = _indices[slot_id].id; // Freelist -> first free.
 
-        // Init slot.
+        // Init slot, its generation becomes odd (alive).
         auto& slot = _indices[slot_id];
         slot.id = _size;
-        slot.generation = _generation;
+        slot.generation = _next_generation(slot.generation);
 
-        // Update space and generation.
+        // Update space.
         ++_size;
-        ++_generation;
-        
+
         return slot_id;
     }
 
-    constexpr void
+    void
     _free_slot(key_t key) noexcept {
         assert(is_key_valid(key));
 
-        auto& slot = _indices[key.id];
-        auto data_id = slot.id; // Save slot to check if it is last or not.
+        auto const slot_id = key_policy_t::index(key);
+        auto data_id = _indices[slot_id].id; // Save slot to check if it is last or not.
 
-        slot.id = _freelist;
-        slot.generation = _generation;
-        _freelist = key.id;
+        (std::destroy_at(&_column<column_index<Ts>>()[data_id]), ...);
 
-        if (data_id != _size - 1) { // Data slot is not last.
-            // Data slot is not last, copy last here.
+        if constexpr (STABLE) {
+            _link_free_slot(slot_id);
+            _leave_holes(std::span { &data_id, 1 });
+            return;
+        }
 
-            _data[data_id] = _data[_size - 1];
+        if (data_id != _size - 1) { // Data slot is not last.
+            // Data slot is not last, move last here.
+            (_relocate(&_column<column_index<Ts>>()[data_id], &_column<column_index<Ts>>()[_size - 1]), ...);
             _erase[data_id] = _erase[_size - 1];
             _indices[_erase[data_id]].id = data_id;
         }
 
-        // Update size and generation.
+        _release_slot(slot_id);
+
+        /*
+            Keep one spare page as hysteresis so an insert/erase pair
+            at a page boundary does not allocate and free every time.
+        */
+        _release_data_pages();
+    }
+
+    /*
+        Links a slot back into the freelist and gives back its dense position
+        (which must be the last one by now). The generation becomes even (free).
+    */
+    void
+    _release_slot(index_t slot_id) noexcept {
+        _link_free_slot(slot_id);
+
+        // Update size.
         --_size;
-        ++_generation;
+    }
+
+    void
+    _link_free_slot(index_t slot_id) noexcept {
+        auto& slot = _indices[slot_id];
+
+        slot.id = _freelist;
+        slot.generation = _next_generation(slot.generation);
+        _freelist = slot_id;
+    }
+
+    /*
+        Moves the element at 'source' into the raw storage at 'destination',
+        leaving 'source' as raw storage too. Trivially relocatable types are
+        a single memcpy, no move constructor and no destructor calls.
+    */
+    template <typename U>
+    static void
+    _relocate(U* destination, U* source) noexcept {
+        if constexpr (is_trivially_relocatable_v<U>) {
+            std::memcpy(static_cast<void*>(destination), static_cast<void const*>(source), sizeof(U));
+        }
+        else {
+            std::construct_at(destination, std::move(*source));
+            std::destroy_at(source);
+        }
+    }
+
+    // Swaps the elements at dense positions 'a' and 'b', both live.
+    void
+    _swap_positions(index_t a, index_t b) noexcept {
+        std::tuple<detail::RawSlot<Ts>...> parked{};
+        (_relocate(std::get<detail::RawSlot<Ts>>(parked).get(), &_column<column_index<Ts>>()[a]), ...);
+        (_relocate(&_column<column_index<Ts>>()[a], &_column<column_index<Ts>>()[b]), ...);
+        (_relocate(&_column<column_index<Ts>>()[b], std::get<detail::RawSlot<Ts>>(parked).get()), ...);
+
+        std::swap(_erase[a], _erase[b]);
+        _indices[_erase[a]].id = a;
+        _indices[_erase[b]].id = b;
+    }
+
+    void
+    _destroy_elements() noexcept {
+        if constexpr (!(std::is_trivially_destructible_v<Ts> && ...)) {
+            _for_each_live([&](index_t i) {
+                (std::destroy_at(&_column<column_index<Ts>>()[i]), ...);
+            });
+        }
+    }
+
+    [[nodiscard]]
+    constexpr size_t
+    _hole_count() const noexcept {
+        if constexpr (STABLE) {
+            return _live.holes;
+        }
+        else {
+            return 0;
+        }
+    }
+
+    [[nodiscard]]
+    bool
+    _is_live(index_t i) const noexcept {
+        if constexpr (STABLE) {
+            return (_live.bits[i / 64] >> (i % 64)) & 1;
+        }
+        else {
+            return i < _size;
+        }
+    }
+
+    // Stable order only: grows the live bitset over 'count' positions, before anything is constructed.
+    void
+    _reserve_live(size_t count) {
+        if constexpr (STABLE) {
+            if ((count + 63) / 64 > _live.bits.size()) {
+                _live.bits.resize((count + 63) / 64);
+            }
+        }
+    }
+
+    // The bitset covers 'i' already, see _reserve_live().
+    void
+    _mark_live(index_t i) noexcept {
+        if constexpr (STABLE) {
+            assert(i / 64 < _live.bits.size());
+            _live.bits[i / 64] |= uint64_t { 1 } << (i % 64);
+        }
+    }
+
+    // Calls 'function' with every dense position holding an element, in order.
+    template <typename F>
+    void
+    _for_each_live(F&& function) const {
+        if constexpr (STABLE) {
+            for (size_t word{}; word < _live.bits.size(); ++word) {
+                auto bits = _live.bits[word];
+
+                while (bits != 0) {
+                    function(static_cast<index_t>(word * 64 + std::countr_zero(bits)));
+                    bits &= bits - 1; // Clear lowest set bit.
+                }
+            }
+        }
+        else {
+            for (index_t i{}; i < _size; ++i) {
+                function(i);
+            }
+        }
+    }
+
+    template <typename TBase>
+    [[nodiscard]]
+    iterator_t<TBase>
+    _iterator_at(TBase base, size_t index) const noexcept {
+        if constexpr (STABLE) {
+            return { base, &_live.bits, &_size, index };
+        }
+        else {
+            return base + index;
+        }
+    }
+
+    void
+    _reserve_slots(size_t count) requires GROWABLE {
+        while (_indices.capacity() < count) {
+            _add_indices_page();
+        }
+    }
+
+    void
+    _reserve_data(size_t count) requires GROWABLE {
+        while (_erase.capacity() < count) {
+            _add_data_page();
+        }
+    }
+
+    [[nodiscard]]
+    static constexpr gen_t
+    _next_generation(gen_t generation) noexcept {
+        return (generation + 1) & key_policy_t::GENERATION_MASK;
+    }
+
+    [[nodiscard]]
+    static constexpr bool
+    _is_alive(Slot const& slot) noexcept {
+        return (slot.generation & 1) != 0;
+    }
+
+    void
+    _add_indices_page() requires GROWABLE {
+        auto const first = static_cast<index_t>(_indices.capacity());
+
+        if (first + array_t<Slot>::PAGE_SIZE > key_policy_t::MAX_SLOTS) {
+            throw std::length_error("Failed to grow slotmap: Key index bits exhausted.");
+        }
+
+        _indices.add_page();
+        _init_slots(first);
+    }
+
+    void
+    _add_data_page() requires GROWABLE {
+        std::apply([](auto&... columns) { (columns.add_page(), ...); }, _data);
+        _erase.add_page();
+    }
+
+    void
+    _pop_data_page() noexcept requires GROWABLE {
+        std::apply([](auto&... columns) { (columns.pop_page(), ...); }, _data);
+        _erase.pop_page();
+    }
+
+    template <size_t I>
+    [[nodiscard]] auto& _column() noexcept { return std::get<I>(_data); }
+
+    template <size_t I>
+    [[nodiscard]] auto const& _column() const noexcept { return std::get<I>(_data); }
+
+    /*
+        Splits [first, last) (all elements by default) in runs that are
+        contiguous in memory: one run for fixed storage, one run per page
+        for paged storage.
+    */
+    template <typename F>
+    void
+    _for_each_range(F&& function) {
+        _for_each_range(0, _size, std::forward<F>(function));
+    }
+
+    template <typename F>
+    void
+    _for_each_range(size_t first, size_t last, F&& function) {
+        if constexpr (GROWABLE) {
+            constexpr auto page_size = array_t<index_t>::PAGE_SIZE;
+
+            while (first < last) {
+                auto const page_end = (first / page_size + 1) * page_size;
+                auto const count = std::min(page_end, last) - first;
+
+                function(first, count);
+                first += count;
+            }
+        }
+        else if (first < last) {
+            function(first, last - first);
+        }
+    }
+
+    [[nodiscard]]
+    static constexpr size_t
+    _pages_needed(size_t count) noexcept requires GROWABLE {
+        constexpr auto page_size = array_t<index_t>::PAGE_SIZE;
+        return (count + page_size - 1) / page_size;
     }
 };
 
+/*
+    Fixed-capacity slotmap, every array lives inline in the object.
+*/
+template <typename T, size_t Capacity = 10, typename TKey = uint64_t>
+using SlotMap = BasicSlotMap<SlotMapPolicy<FixedStorage<Capacity>, TKey>, T>;
+
+/*
+    Growable slotmap, arrays are allocated in pages of 'PageSize' elements
+    when needed. Growing never moves existing elements, so pointers and
+    iterators stay valid (erasing still moves the last element, as usual).
+*/
+template <typename T, size_t PageSize = 1024, typename TKey = uint64_t>
+using PagedSlotMap = BasicSlotMap<SlotMapPolicy<PagedStorage<PageSize>, TKey>, T>;
+
+/*
+    Growable slotmap that keeps insertion order: erasing leaves a hole
+    instead of moving the last element, see StableOrder.
+*/
+template <typename T, size_t PageSize = 1024, typename TKey = uint64_t>
+using StableSlotMap = BasicSlotMap<SlotMapPolicy<PagedStorage<PageSize>, TKey, StableOrder<>>, T>;
+
+/*
+    Growable slotmap with several columns under the same key, e.g.
+    MultiSlotMap<Position, Velocity, Health>. Each column is its own dense
+    array, so iterating a subset of columns only streams those bytes.
+*/
+template <typename... Ts>
+using MultiSlotMap = BasicSlotMap<SlotMapPolicy<PagedStorage<>>, Ts...>;
+
+/*
+    The production layout: with ReleaseLayout the hot scalars and the array
+    heads of a paged slotmap share one cache line and nothing sits between
+    them.
+*/
+namespace detail {
+
+using ReleasePagedSlotMap = BasicSlotMap<SlotMapPolicy<PagedStorage<>, uint64_t, SwapOrder, ReleaseLayout>, uint64_t>;
+constexpr LayoutReport RELEASE_PAGED_LAYOUT = ReleasePagedSlotMap::layout_report();
+
+} // namespace detail
+
+static_assert(detail::RELEASE_PAGED_LAYOUT.tag_bytes == 0, "Release slotmaps must not carry debug tags.");
+static_assert(detail::RELEASE_PAGED_LAYOUT.hot_offset == 0, "Release slotmaps must start with their hot members.");
+static_assert(detail::RELEASE_PAGED_LAYOUT.hot_is_packed(), "Release slotmap hot members must be packed.");
+static_assert(detail::RELEASE_PAGED_LAYOUT.hot_in_one_line(), "Release slotmap hot members must share one cache line.");
+static_assert(detail::RELEASE_PAGED_LAYOUT.object_alignment == CACHE_LINE_SIZE, "Release slotmaps must start on a cache line.");
+
 }
@@ -0,0 +1,204 @@
+#pragma once
+
+// std
+#include <bit>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <stdint.h>
+#include <cassert>
+
+namespace vecs {
+
+/*
+    Maps entity ids to values with O(1) insert, erase and lookup, and keeps
+    the values packed for iteration.
+
+    - sparse: entity id -> dense position, allocated in pages so large or
+      scattered ids only cost the pages they touch.
+    - dense: the entity of every position, plus the values in the same
+      order. Erasing moves the last value into the hole, nothing else moves.
+
+    Empty types (tags) store no values at all, only membership, and every
+    lookup hands out the same instance.
+*/
+template <typename T, typename TEntity = size_t, size_t PageSize = 4096>
+class SparseSet {
+    static_assert(std::has_single_bit(PageSize), "PageSize must be a power of two.");
+
+public:
+    using entity_t = TEntity;
+    using index_t  = uint32_t;
+    using value_type = T;
+
+    static constexpr index_t NONE = std::numeric_limits<index_t>::max();
+    static constexpr bool STORES_VALUES = !std::is_empty_v<T>;
+
+private:
+    static constexpr size_t PAGE_SHIFT = std::countr_zero(PageSize);
+    static constexpr size_t PAGE_MASK  = PageSize - 1;
+
+    std::vector<std::unique_ptr<index_t[]>> _sparse{};
+    std::vector<TEntity> _entities{};
+    std::conditional_t<STORES_VALUES, std::vector<T>, T> _values{}; // One shared instance for tags.
+
+public:
+    [[nodiscard]] inline size_t size() const noexcept { return _entities.size(); }
+    [[nodiscard]] inline bool empty() const noexcept { return _entities.empty(); }
+
+    // Dense arrays, position 'i' of both belongs to the same entity.
+    [[nodiscard]] inline std::span<TEntity const> entities() const noexcept { return _entities; }
+    [[nodiscard]] inline std::span<T> values() noexcept requires STORES_VALUES { return _values; }
+    [[nodiscard]] inline std::span<T const> values() const noexcept requires STORES_VALUES { return _values; }
+
+    [[nodiscard]]
+    index_t
+    index_of(TEntity entity) const noexcept {
+        auto const page = static_cast<size_t>(entity) >> PAGE_SHIFT;
+        return page < _sparse.size() && _sparse[page] ? _sparse[page][entity & PAGE_MASK] : NONE;
+    }
+
+    [[nodiscard]] inline bool contains(TEntity entity) const noexcept { return index_of(entity) != NONE; }
+
+    // The entity must be in the set, use try_get() when that is not known.
+    [[nodiscard]]
+    T&
+    get(TEntity entity) noexcept {
+        assert(contains(entity));
+        return _value(index_of(entity));
+    }
+
+    [[nodiscard]]
+    T*
+    try_get(TEntity entity) noexcept {
+        auto const index = index_of(entity);
+        return index != NONE ? &_value(index) : nullptr;
+    }
+
+    // Builds the value of 'entity', or assigns it when the entity is already in.
+    template <typename... Args>
+    T&
+    emplace(TEntity entity, Args&&... args) {
+        auto& slot = _sparse_slot(entity);
+
+        if (slot != NONE) {
+            return _value(slot) = T(std::forward<Args>(args)...);
+        }
+
+        assert(_entities.size() < NONE && "SparseSet is full");
+
+        if constexpr (STORES_VALUES) {
+            _values.emplace_back(std::forward<Args>(args)...);
+            try {
+                _entities.push_back(entity);
+            }
+            catch (...) {
+                _values.pop_back();
+                throw;
+            }
+        }
+        else {
+            _entities.push_back(entity);
+        }
+
+        slot = static_cast<index_t>(_entities.size() - 1);
+
+        return _value(slot);
+    }
+
+    // Returns false when 'entity' was not in the set.
+    bool
+    erase(TEntity entity) noexcept {
+        auto const index = index_of(entity);
+        if (index == NONE) {
+            return false;
+        }
+
+        auto const last = static_cast<index_t>(_entities.size() - 1);
+        if (index != last) {
+            if constexpr (STORES_VALUES) {
+                _values[index] = std::move(_values[last]);
+            }
+
+            _entities[index] = _entities[last];
+            _sparse[_entities[index] >> PAGE_SHIFT][_entities[index] & PAGE_MASK] = index;
+        }
+
+        if constexpr (STORES_VALUES) {
+            _values.pop_back();
+        }
+
+        _entities.pop_back();
+        _sparse[entity >> PAGE_SHIFT][entity & PAGE_MASK] = NONE;
+
+        return true;
+    }
+
+    // Exchanges two dense positions, entities and values, keeping lookups right.
+    void
+    swap_at(index_t a, index_t b) noexcept {
+        assert(a < size() && b < size());
+
+        if (a == b) {
+            return;
+        }
+
+        if constexpr (STORES_VALUES) {
+            using std::swap;
+            swap(_values[a], _values[b]);
+        }
+
+        std::swap(_entities[a], _entities[b]);
+        _sparse[_entities[a] >> PAGE_SHIFT][_entities[a] & PAGE_MASK] = a;
+        _sparse[_entities[b] >> PAGE_SHIFT][_entities[b] & PAGE_MASK] = b;
+    }
+
+    void
+    clear() noexcept {
+        for (auto entity: _entities) {
+            _sparse[entity >> PAGE_SHIFT][entity & PAGE_MASK] = NONE;
+        }
+
+        _entities.clear();
+
+        if constexpr (STORES_VALUES) {
+            _values.clear();
+        }
+    }
+
+private:
+    [[nodiscard]]
+    T&
+    _value([[maybe_unused]] index_t index) noexcept {
+        if constexpr (STORES_VALUES) {
+            return _values[index];
+        }
+        else {
+            return _values;
+        }
+    }
+
+    // Sparse entry of 'entity', allocating its page (all NONE) when missing.
+    [[nodiscard]]
+    index_t&
+    _sparse_slot(TEntity entity) {
+        auto const page = static_cast<size_t>(entity) >> PAGE_SHIFT;
+
+        if (page >= _sparse.size()) {
+            _sparse.resize(page + 1);
+        }
+
+        if (!_sparse[page]) {
+            _sparse[page] = std::make_unique_for_overwrite<index_t[]>(PageSize);
+            std::fill_n(_sparse[page].get(), PageSize, NONE);
+        }
+
+        return _sparse[page][entity & PAGE_MASK];
+    }
+};
+
+} // namespace vecs
@@ -0,0 +1,187 @@
+#pragma once
+
+// std
+#include <bit>
+#include <memory>
+#include <vector>
+#include <new>
+#include <iterator>
+#include <type_traits>
+#include <stdint.h>
+#include <cstddef>
+
+namespace vecs {
+
+/*
+    Storage policies decide where the arrays of a slotmap live.
+
+    FixedStorage keeps every array inline inside the owning object, sized
+    to 'Capacity' at compile time (this is what the original SlotMap did).
+    PagedStorage allocates arrays in pages of 'PageSize' elements on demand,
+    pages are never moved once allocated, so element addresses stay valid
+    while the container grows.
+
+    Both arrays are raw, suitably aligned storage: nothing is constructed
+    or destroyed by them. The owner placement-constructs the elements it
+    uses and destroys them, so 'T' does not need a default constructor.
+    'Align' raises the alignment of the array start (inline array or every
+    page), e.g. to a cache line.
+*/
+
+/*
+    Types that can be moved to another address with a plain memcpy (and
+    the source then forgotten, no destructor call). Every trivially
+    copyable type is, specialize it for other types that are too (e.g.
+    types owning a heap pointer with no back references).
+*/
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <typename T, size_t Capacity, size_t Align = alignof(T)>
+struct FixedArray {
+    static_assert(std::has_single_bit(Align) && Align >= alignof(T), "Align must be a power of two, at least alignof(T).");
+
+public:
+    using value_type     = T;
+    using iterator       = T*;
+    using const_iterator = T const*;
+
+    static constexpr bool GROWABLE = false;
+    static constexpr size_t CAPACITY = Capacity;
+
+    // Empty on purpose, the bytes are left uninitialized.
+    FixedArray() noexcept {}
+
+    // Only the owner knows which elements are alive.
+    FixedArray(FixedArray const&) = delete;
+    FixedArray& operator=(FixedArray const&) = delete;
+
+    [[nodiscard]] inline T& operator[](size_t i) noexcept { return begin()[i]; }
+    [[nodiscard]] inline T const& operator[](size_t i) const noexcept { return begin()[i]; }
+    [[nodiscard]] inline constexpr size_t capacity() const noexcept { return Capacity; }
+    [[nodiscard]] iterator begin() noexcept { return std::launder(reinterpret_cast<T*>(_bytes)); }
+    [[nodiscard]] const_iterator begin() const noexcept { return std::launder(reinterpret_cast<T const*>(_bytes)); }
+
+private:
+    alignas(Align) std::byte _bytes[sizeof(T) * Capacity];
+};
+
+// Pages are raw memory, the deleter only returns the allocation.
+template <typename T, size_t Align = alignof(T)>
+struct PageDeleter {
+    void operator()(T* page) const noexcept { ::operator delete(page, std::align_val_t { Align }); }
+};
+
+template <typename T, size_t Align = alignof(T)>
+using page_ptr = std::unique_ptr<T, PageDeleter<T, Align>>;
+
+template <typename T, size_t PageSize, size_t Align = alignof(T)>
+class PagedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::remove_const_t<T>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T*;
+    using reference         = T&;
+    using pages_t           = std::vector<page_ptr<value_type, Align>>;
+
+    static constexpr size_t PAGE_SHIFT = std::countr_zero(PageSize);
+    static constexpr size_t PAGE_MASK  = PageSize - 1;
+
+    constexpr PagedIterator() noexcept = default;
+    /*
+        The iterator points to the vector of pages instead of its buffer,
+        that buffer reallocates when a page is added and the iterator must
+        survive growth.
+    */
+    constexpr PagedIterator(pages_t const* pages, size_t index) noexcept
+        : _pages(pages), _index(index) {}
+
+    // Allow iterator -> const_iterator.
+    constexpr operator PagedIterator<T const, PageSize, Align>() const noexcept { return { _pages, _index }; }
+
+    [[nodiscard]] constexpr reference operator*() const noexcept { return (*_pages)[_index >> PAGE_SHIFT].get()[_index & PAGE_MASK]; }
+    [[nodiscard]] constexpr pointer operator->() const noexcept { return &**this; }
+    [[nodiscard]] constexpr reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    constexpr PagedIterator& operator++() noexcept { ++_index; return *this; }
+    constexpr PagedIterator& operator--() noexcept { --_index; return *this; }
+    constexpr PagedIterator operator++(int) noexcept { auto copy { *this }; ++_index; return copy; }
+    constexpr PagedIterator operator--(int) noexcept { auto copy { *this }; --_index; return copy; }
+    constexpr PagedIterator& operator+=(difference_type n) noexcept { _index += n; return *this; }
+    constexpr PagedIterator& operator-=(difference_type n) noexcept { _index -= n; return *this; }
+
+    [[nodiscard]] friend constexpr PagedIterator operator+(PagedIterator it, difference_type n) noexcept { return it += n; }
+    [[nodiscard]] friend constexpr PagedIterator operator+(difference_type n, PagedIterator it) noexcept { return it += n; }
+    [[nodiscard]] friend constexpr PagedIterator operator-(PagedIterator it, difference_type n) noexcept { return it -= n; }
+    [[nodiscard]] friend constexpr difference_type operator-(PagedIterator const& a, PagedIterator const& b) noexcept {
+        return static_cast<difference_type>(a._index) - static_cast<difference_type>(b._index);
+    }
+
+    [[nodiscard]] friend constexpr bool operator==(PagedIterator const& a, PagedIterator const& b) noexcept { return a._index == b._index; }
+    [[nodiscard]] friend constexpr auto operator<=>(PagedIterator const& a, PagedIterator const& b) noexcept { return a._index <=> b._index; }
+
+private:
+    pages_t const* _pages{};
+    size_t _index{};
+};
+
+template <typename T, size_t PageSize, size_t Align = alignof(T)>
+class PagedArray {
+    static_assert(std::has_single_bit(PageSize), "PageSize must be a power of two.");
+    static_assert(std::has_single_bit(Align) && Align >= alignof(T), "Align must be a power of two, at least alignof(T).");
+
+public:
+    using value_type     = T;
+    using iterator       = PagedIterator<T, PageSize, Align>;
+    using const_iterator = PagedIterator<T const, PageSize, Align>;
+
+    static constexpr bool GROWABLE = true;
+    static constexpr size_t PAGE_SIZE  = PageSize;
+    static constexpr size_t PAGE_SHIFT = iterator::PAGE_SHIFT;
+    static constexpr size_t PAGE_MASK  = iterator::PAGE_MASK;
+
+    [[nodiscard]] inline T& operator[](size_t i) noexcept { return _pages[i >> PAGE_SHIFT].get()[i & PAGE_MASK]; }
+    [[nodiscard]] inline T const& operator[](size_t i) const noexcept { return _pages[i >> PAGE_SHIFT].get()[i & PAGE_MASK]; }
+    [[nodiscard]] inline size_t capacity() const noexcept { return _pages.size() * PageSize; }
+    [[nodiscard]] inline size_t page_count() const noexcept { return _pages.size(); }
+    [[nodiscard]] iterator begin() noexcept { return { &_pages, 0 }; }
+    [[nodiscard]] const_iterator begin() const noexcept { return { &_pages, 0 }; }
+
+    /*
+        Only the vector of page pointers may reallocate here, the pages
+        themselves (and the elements inside them) never move.
+    */
+    T*
+    add_page() {
+        // Owned before the vector may reallocate, a throwing push_back() frees it.
+        page_ptr<T, Align> page { static_cast<T*>(::operator new(sizeof(T) * PageSize, std::align_val_t { Align })) };
+        _pages.push_back(std::move(page));
+        return _pages.back().get();
+    }
+
+    void
+    pop_page() noexcept {
+        _pages.pop_back();
+    }
+
+private:
+    std::vector<page_ptr<T, Align>> _pages{};
+};
+
+template <size_t Capacity>
+struct FixedStorage {
+    template <typename T, size_t Align = alignof(T)>
+    using array_t = FixedArray<T, Capacity, Align>;
+};
+
+template <size_t PageSize = 1024>
+struct PagedStorage {
+    template <typename T, size_t Align = alignof(T)>
+    using array_t = PagedArray<T, PageSize, Align>;
+};
+
+} // namespace vecs
@@ -1,30 +1,1424 @@
 #pragma once
 
+// std
+#include <map>
+#include <tuple>
+#include <array>
 #include <vector>
-#include <unordered_map>
-#include <typeindex>
 #include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <concepts>
+#include <span>
+#include <stdexcept>
+#include <cassert>
+
+#include "component.hpp"
+#include "data_structures/key.hpp"
+#include "data_structures/slotmap.hpp"
+#include "data_structures/archetype.hpp"
+#include "data_structures/sparse_set.hpp"
+#include "job_system.hpp"
+#include "parallel.hpp"
 
 namespace vecs {
 
-    using EntityId = size_t;
+/*
+    Where the World keeps a component type.
+
+    Archetype storage (the default) packs components that are used together
+    in the same tables, best for iteration. Adding or removing one moves
+    every component of the entity to another table though.
+    Sparse storage keeps the type in its own SparseSet pool: adding and
+    removing are O(1) and touch nothing else, best for high-churn data such
+    as status effects or tags.
+
+    Choose with a 'static constexpr ComponentStorage STORAGE' member, or by
+    specializing component_storage for types you cannot edit.
+*/
+enum class ComponentStorage { Archetype, Sparse };
+
+template <typename T>
+struct component_storage : std::integral_constant<ComponentStorage, ComponentStorage::Archetype> {};
+
+template <typename T>
+requires requires { { T::STORAGE } -> std::convertible_to<ComponentStorage>; }
+struct component_storage<T> : std::integral_constant<ComponentStorage, T::STORAGE> {};
+
+template <typename T>
+inline constexpr bool is_sparse_component_v = component_storage<std::remove_const_t<T>>::value == ComponentStorage::Sparse;
+
+// What the World hands out for a 'T': plain references and pointers, proxies for split types (see soa.hpp).
+template <typename T>
+struct component_access {
+    using ref_t  = T&;
+    using ptr_t  = T*;
+    using span_t = std::span<T>;
+};
+
+template <SoaComponent T>
+struct component_access<T> {
+    using ref_t  = soa_ref_t<T>;
+    using ptr_t  = SoaPtr<T>;
+    using span_t = soa_spans_t<T>;
+};
+
+template <typename T>
+using component_ref_t = typename component_access<T>::ref_t;
+
+template <typename T>
+using component_ptr_t = typename component_access<T>::ptr_t;
+
+template <typename T>
+using chunk_span_t = typename component_access<T>::span_t;
+
+namespace detail {
+
+// Lets the pools owned by a group tell it when one of their entities comes or goes.
+struct GroupBase {
+    virtual ~GroupBase() = default;
+
+    virtual void added(EntityId entity) noexcept = 0;
+    virtual void removing(EntityId entity) noexcept = 0;
+};
+
+struct GroupFamily {};
+
+// Type-erased sparse pool, lets the World drop an entity from every pool.
+struct PoolBase {
+    GroupBase* group{}; // Owning group, nullptr when the pool is free.
+
+    virtual ~PoolBase() = default;
+
+    [[nodiscard]] virtual bool contains(EntityId entity) const noexcept = 0;
+    [[nodiscard]] virtual std::span<EntityId const> entities() const noexcept = 0;
+    virtual bool remove(EntityId entity) noexcept = 0;
+};
+
+template <typename T>
+struct Pool final : PoolBase {
+    SparseSet<T, EntityId> set{};
+
+    [[nodiscard]] bool contains(EntityId entity) const noexcept override { return set.contains(entity); }
+    [[nodiscard]] std::span<EntityId const> entities() const noexcept override { return set.entities(); }
+    bool remove(EntityId entity) noexcept override { return set.erase(entity); }
+};
+
+template <typename T>
+using set_t = SparseSet<std::remove_const_t<T>, EntityId>;
+
+template <typename T>
+struct source {
+    using type = T*;
+};
+
+template <SoaComponent T>
+struct source<T> {
+    using type = soa_pointers_t<T>;
+};
+
+// Where a view reads a 'T' from: a chunk array (one per field when split), or the sparse pool.
+template <typename T>
+using source_t = std::conditional_t<is_sparse_component_v<T>, set_t<T>*, typename source<T>::type>;
+
+// Matching archetype of a cached query, with the column of every queried type.
+template <size_t N>
+struct CachedTable {
+    Archetype* archetype;
+    std::array<size_t, N> columns;
+};
+
+// Lets the World tell every query when archetypes come and go.
+struct QueryBase {
+    virtual ~QueryBase() = default;
+
+    virtual void archetype_created(Archetype& archetype) = 0;
+    virtual void archetype_destroyed(Archetype& archetype) noexcept = 0;
+};
+
+struct QueryFamily {};
+
+} // namespace detail
+
+/*
+    Generational entity handle issued by World::create_entity(). The low 32
+    bits are the EntityId every storage is keyed by, the high bits the
+    generation of that id: once the entity is destroyed its id is reused,
+    with a new generation, and the old handle reads as dead.
+*/
+using EntityKey = PackedKey<uint64_t, 32>;
+using Entity    = EntityKey::type;
+
+template <typename... Ts>
+class View;
+
+template <typename... Ts>
+class Query;
+
+template <typename... Ts>
+class Group;
+
+/*
+    Stores components in archetypes (see archetype.hpp): every entity lives
+    in the table of its exact set of component types, so iterating a set
+    of components is a linear sweep over packed arrays. Adding or removing
+    a component moves the entity to the neighbour table, found through the
+    cached edges of its current one.
+
+    Sparse components (see ComponentStorage) live in one pool per type
+    instead and never move the entity between tables.
+
+    Entities come from create_entity(): ids are recycled (last destroyed,
+    first reused) so they stay dense, which keeps the records and every
+    sparse index small. The functions taking an EntityId still accept ids
+    chosen by the caller, as long as they are not mixed with created ones
+    and fit the index of an Entity. Records are paged like the sparse
+    index of SparseSet, scattered ids only cost the pages they touch.
+*/
+class World {
+private:
+    struct EntityRecord {
+        Archetype* archetype{}; // nullptr while the entity has no components.
+        size_t row{};
+    };
+
+    static constexpr size_t RECORD_PAGE_SIZE = 1024;
+
+    using signature_t = std::vector<ComponentId>;
+
+    PagedSlotMap<EntityId, 1024, EntityKey> _entities{}; // Allocator, the value is the id of the handle.
+    std::vector<std::unique_ptr<EntityRecord[]>> _records{}; // Pages of RECORD_PAGE_SIZE, by EntityId.
+    std::vector<std::unique_ptr<Archetype>> _archetypes{};
+    std::map<signature_t, Archetype*> _archetype_index{};
+    std::vector<Archetype*> _root_edges{};                 // Single component archetypes, by ComponentId.
+    std::vector<std::unique_ptr<detail::PoolBase>> _pools{}; // Sparse pools, by ComponentId.
+    std::vector<std::unique_ptr<detail::QueryBase>> _queries{}; // Cached queries, by query type id.
+    std::vector<std::unique_ptr<detail::GroupBase>> _groups{};  // Owning groups, by group type id.
+
+    template <typename T>
+    using set_t = detail::set_t<T>;
+
+    template <typename T>
+    using source_t = detail::source_t<T>;
+
+    template <typename... Ts>
+    friend class View;
+
+    template <typename... Ts>
+    friend class Query;
+
+    template <typename... Ts>
+    friend class Group;
+
+public:
+    World() = default;
+    World(World const&) = delete;
+    World& operator=(World const&) = delete;
+
+    // New entity with no components, reusing the id of the last destroyed one if any.
+    [[nodiscard]]
+    Entity
+    create_entity() {
+        auto const entity = _entities.push_back(EntityId{});
+        _entities.get(entity) = entity.index();
+
+        return entity;
+    }
+
+    // O(1), false for handles of destroyed entities.
+    [[nodiscard]] inline bool is_alive(Entity entity) const noexcept { return _entities.is_key_valid(entity); }
+    [[nodiscard]] inline size_t entity_count() const noexcept { return _entities.size(); }
+
+    /*
+        O(1), handle of the live entity with 'entityId', e.g. to record
+        commands from a view callback. A default handle (never alive) when
+        no created entity has that id.
+    */
+    [[nodiscard]]
+    Entity
+    entity(EntityId entityId) const noexcept {
+        return entityId < EntityKey::MAX_SLOTS ? _entities.key_of_slot(entityId) : Entity{};
+    }
+
+    // Removes every component of 'entity' and frees its id. Returns false when 'entity' is stale.
+    bool
+    destroy_entity(Entity entity) noexcept {
+        if (!is_alive(entity)) {
+            return false;
+        }
+
+        destroy_entity(entity.index());
+        _entities.erase(entity);
+
+        return true;
+    }
+
+    // Throws std::invalid_argument when 'entity' is stale, its id may belong to another entity by now.
+    template <Component T>
+    void
+    add_component(Entity entity, T component) {
+        emplace_component<T>(entity, std::move(component));
+    }
+
+    // Throws std::invalid_argument when 'entity' is stale, see add_component().
+    template <Component T, typename... Args>
+    component_ref_t<T>
+    emplace_component(Entity entity, Args&&... args) {
+        if (!is_alive(entity)) {
+            throw std::invalid_argument("Failed to add component: Entity is not alive.");
+        }
+
+        return emplace_component<T>(entity.index(), std::forward<Args>(args)...);
+    }
+
+    // Returns false when 'entity' is stale or had no 'T'.
+    template <typename T>
+    bool
+    remove_component(Entity entity) {
+        return is_alive(entity) && remove_component<T>(entity.index());
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    bool
+    has_component(Entity entity) const noexcept {
+        return is_alive(entity) && has_component<T>(entity.index());
+    }
+
+    // Returns nullptr when 'entity' is stale or has no 'T'.
+    template <typename T>
+    [[nodiscard]]
+    component_ptr_t<T>
+    get_component(Entity entity) noexcept {
+        return is_alive(entity) ? get_component<T>(entity.index()) : nullptr;
+    }
+
+    /*
+        Adds 'component' to 'entityId', or overwrites it when the entity has
+        that component already.
+    */
+    template <Component T>
+    void
+    add_component(EntityId entityId, T component) {
+        emplace_component<T>(entityId, std::move(component));
+    }
+
+    /*
+        Same as add_component(), but builds the component in place from
+        'args' (aggregates included), returns it. A split type is built
+        first, then scattered into its field arrays.
+    */
+    template <Component T, typename... Args>
+    component_ref_t<T>
+    emplace_component(EntityId entityId, Args&&... args) {
+        static_assert(!(SoaComponent<T> && is_sparse_component_v<T>), "Split components need archetype storage.");
+
+        if (entityId >= EntityKey::MAX_SLOTS) {
+            throw std::out_of_range("Failed to add component: Entity id does not fit an entity handle.");
+        }
+
+        if constexpr (is_sparse_component_v<T>) {
+            return _emplace_in_pool<T>(entityId, std::forward<Args>(args)...);
+        }
+        else {
+            return _emplace_in_archetype<T>(entityId, std::forward<Args>(args)...);
+        }
+    }
+
+    // Returns false when 'entityId' had no 'T'.
+    template <typename T>
+    bool
+    remove_component(EntityId entityId) {
+        if constexpr (is_sparse_component_v<T>) {
+            auto const id = component_id<T>();
+            return id < _pools.size() && _pools[id] != nullptr && _remove_from_pool(*_pools[id], entityId);
+        }
+        else {
+            return _remove_from_archetype<T>(entityId);
+        }
+    }
+
+    [[nodiscard]]
+    bool
+    has_component(EntityId entityId, ComponentId id) const noexcept {
+        if (id < _pools.size() && _pools[id] != nullptr) {
+            return _pools[id]->contains(entityId);
+        }
+
+        auto const* record = _find_record(entityId);
+        return record != nullptr && record->archetype->has(id);
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    bool
+    has_component(EntityId entityId) const noexcept {
+        return has_component(entityId, component_id<T>());
+    }
+
+    // Returns nullptr when 'entityId' has no 'T'. Adding or removing components may move it.
+    template <typename T>
+    [[nodiscard]]
+    component_ptr_t<T>
+    get_component(EntityId entityId) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            auto* set = _find_set<T>();
+            return set != nullptr ? set->try_get(entityId) : nullptr;
+        }
+        else {
+            return _get_from_archetype<T>(entityId);
+        }
+    }
+
+    // Removes every component of 'entityId'.
+    void
+    destroy_entity(EntityId entityId) noexcept {
+        if (_find_record(entityId) != nullptr) {
+            _erase_row(_record_at(entityId));
+        }
+
+        for (auto& pool: _pools) {
+            if (pool != nullptr) {
+                _remove_from_pool(*pool, entityId);
+            }
+        }
+    }
+
+    [[nodiscard]] inline size_t archetype_count() const noexcept { return _archetypes.size(); }
+
+    /*
+        View over every entity that has all of 'Ts' (const for read only
+        access), see View. Cheap to build, build it where it is iterated.
+    */
+    template <typename... Ts>
+    [[nodiscard]]
+    View<Ts...>
+    view() noexcept {
+        return View<Ts...> { *this };
+    }
+
+    /*
+        Cached query over 'Ts', see Query. Built on the first call, later
+        calls with the same types return the same object, so systems can
+        keep the reference or ask for it every frame.
+    */
+    template <typename... Ts>
+    [[nodiscard]]
+    Query<Ts...>&
+    query() {
+        auto const id = detail::TypeCounter<detail::QueryFamily>::id<Query<Ts...>>();
+        if (id >= _queries.size()) {
+            _queries.resize(id + 1);
+        }
+
+        if (_queries[id] == nullptr) {
+            _queries[id] = std::make_unique<Query<Ts...>>(*this);
+        }
+
+        return static_cast<Query<Ts...>&>(*_queries[id]);
+    }
+
+    /*
+        Destroys every archetype left without entities and returns how many
+        went. Cached queries drop them, the next entity needing one of those
+        component sets builds it again.
+    */
+    size_t
+    prune_archetypes() {
+        std::vector<Archetype*> gone{};
+        for (auto const& archetype: _archetypes) {
+            if (archetype->size() == 0) {
+                gone.push_back(archetype.get());
+            }
+        }
+
+        std::sort(gone.begin(), gone.end());
+        auto const is_gone = [&](Archetype* archetype) { return std::binary_search(gone.begin(), gone.end(), archetype); };
+
+        for (auto* archetype: gone) {
+            for (auto& query: _queries) {
+                if (query != nullptr) {
+                    query->archetype_destroyed(*archetype);
+                }
+            }
+        }
+
+        for (auto& root: _root_edges) {
+            root = (root != nullptr && is_gone(root)) ? nullptr : root;
+        }
+
+        for (auto const& archetype: _archetypes) {
+            archetype->drop_edges(is_gone);
+        }
+
+        std::erase_if(_archetype_index, [&](auto const& entry) { return is_gone(entry.second); });
+        std::erase_if(_archetypes, [&](auto const& archetype) { return is_gone(archetype.get()); });
+
+        return gone.size();
+    }
+
+    /*
+        Owning group over the sparse types 'Ts', see Group. Built on the
+        first call, which packs the entities already having all of 'Ts'.
+        A pool belongs to one group at most, asking for a second group
+        over an owned type throws std::logic_error.
+    */
+    template <typename... Ts>
+    [[nodiscard]]
+    Group<std::remove_const_t<Ts>...>&
+    group() {
+        using group_t = Group<std::remove_const_t<Ts>...>;
+
+        auto const id = detail::TypeCounter<detail::GroupFamily>::id<group_t>();
+        if (id >= _groups.size()) {
+            _groups.resize(id + 1);
+        }
+
+        if (_groups[id] == nullptr) {
+            _groups[id] = std::make_unique<group_t>(*this);
+        }
+
+        return static_cast<group_t&>(*_groups[id]);
+    }
+
+    // Shorthand for view<Ts...>().each(function).
+    template <typename... Ts, typename F>
+    void
+    each(F&& function) {
+        view<Ts...>().each(std::forward<F>(function));
+    }
+
+private:
+    template <SoaComponent T, typename... Args>
+    soa_ref_t<T>
+    _emplace_in_archetype(EntityId entityId, Args&&... args) {
+        T const component(std::forward<Args>(args)...);
+        auto& record = _record(entityId);
+        auto* archetype = record.archetype;
+        auto row = record.row;
+
+        if (archetype == nullptr || !archetype->has(component_id<T>())) {
+            archetype = _add_edge(record.archetype, component_info<T>());
+            row = archetype->push_row(entityId);
+
+            // Nothing below can throw, the other components move and the fields are copied.
+            _move_entity(record, archetype, row);
+        }
+
+        auto const fields = _soa_fields<T>(*archetype, archetype->column_of(component_id<T>()), row);
+        detail::soa_store<T>(fields, 0, component, detail::soa_sequence_t<T>{});
+
+        return detail::soa_ref_at<T>(fields, 0, detail::soa_sequence_t<T>{});
+    }
+
+    template <typename T, typename... Args>
+    T&
+    _emplace_in_archetype(EntityId entityId, Args&&... args) {
+        auto& record = _record(entityId);
+        auto* source = record.archetype;
+
+        if (source != nullptr) {
+            if (auto const column = source->column_of(component_id<T>()); column != Archetype::NO_COLUMN) {
+                auto* component = static_cast<T*>(source->at(column, record.row));
+                return *component = T(std::forward<Args>(args)...);
+            }
+        }
+
+        auto* destination = _add_edge(source, component_info<T>());
+        auto const row = destination->push_row(entityId);
+        auto* component = static_cast<T*>(destination->at(destination->column_of(component_id<T>()), row));
+
+        try {
+            std::construct_at(component, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            destination->pop_raw_row();
+            throw;
+        }
+
+        // Moving components is noexcept (see Component), nothing below can throw.
+        _move_entity(record, destination, row);
+
+        return *component;
+    }
+
+    template <typename T>
+    bool
+    _remove_from_archetype(EntityId entityId) {
+        if (!has_component<T>(entityId)) {
+            return false;
+        }
+
+        auto& record = _record_at(entityId);
+        auto* destination = _remove_edge(record.archetype, component_info<T>());
+
+        if (destination == nullptr) { // 'T' was the last component.
+            _erase_row(record);
+            return true;
+        }
+
+        _move_entity(record, destination, destination->push_row(entityId));
+
+        return true;
+    }
+
+    template <typename T, typename... Args>
+    T&
+    _emplace_in_pool(EntityId entityId, Args&&... args) {
+        auto& pool = _pool<T>();
+        auto& component = pool.set.emplace(entityId, std::forward<Args>(args)...);
+
+        if (pool.group == nullptr) {
+            return component;
+        }
+
+        // The group may swap the entity to its packed front.
+        pool.group->added(entityId);
+
+        return pool.set.get(entityId);
+    }
+
+    bool
+    _remove_from_pool(detail::PoolBase& pool, EntityId entityId) noexcept {
+        if (pool.group != nullptr && pool.contains(entityId)) {
+            pool.group->removing(entityId);
+        }
+
+        return pool.remove(entityId);
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    component_ptr_t<T>
+    _get_from_archetype(EntityId entityId) noexcept {
+        auto const* found = _find_record(entityId);
+        if (found == nullptr) {
+            return nullptr;
+        }
+
+        auto const& record = *found;
+        auto const column = record.archetype->column_of(component_id<T>());
+
+        if (column == Archetype::NO_COLUMN) {
+            return nullptr;
+        }
+
+        if constexpr (SoaComponent<T>) {
+            auto const fields = _soa_fields<T>(*record.archetype, column, record.row);
+            return SoaPtr<T> { detail::soa_ref_at<T>(fields, 0, detail::soa_sequence_t<T>{}) };
+        }
+        else {
+            return static_cast<T*>(record.archetype->at(column, record.row));
+        }
+    }
+
+    // Pointers to the fields of the split 'T' at 'row' of 'column'.
+    template <SoaComponent T>
+    [[nodiscard]]
+    static detail::soa_pointers_t<T>
+    _soa_fields(Archetype& archetype, size_t column, size_t row) noexcept {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return detail::soa_pointers_t<T> { static_cast<detail::soa_field_t<T, Is>*>(archetype.field_at(column, Is, row))... };
+        }(detail::soa_sequence_t<T>{});
+    }
+
+    // Pool of sparse 'T', or nullptr when there is none yet (or 'T' is not sparse).
+    template <typename T>
+    [[nodiscard]]
+    source_t<T>
+    _find_set() noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            auto const id = component_id<T>();
+            return id < _pools.size() && _pools[id] != nullptr ? &static_cast<detail::Pool<std::remove_const_t<T>>&>(*_pools[id]).set : nullptr;
+        }
+        else {
+            return {}; // Unused by views.
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    detail::Pool<T>&
+    _pool() {
+        auto const id = component_id<T>();
+        if (id >= _pools.size()) {
+            _pools.resize(id + 1);
+        }
+
+        auto& pool = _pools[id];
+        if (pool == nullptr) {
+            pool = std::make_unique<detail::Pool<T>>();
+        }
+
+        return static_cast<detail::Pool<T>&>(*pool);
+    }
+
+    [[nodiscard]]
+    EntityRecord&
+    _record(EntityId entityId) {
+        assert(entityId < EntityKey::MAX_SLOTS);
+        auto const page = entityId / RECORD_PAGE_SIZE;
+
+        if (page >= _records.size()) {
+            _records.resize(page + 1);
+        }
+
+        if (_records[page] == nullptr) {
+            _records[page] = std::make_unique<EntityRecord[]>(RECORD_PAGE_SIZE);
+        }
+
+        return _records[page][entityId % RECORD_PAGE_SIZE];
+    }
+
+    // Record of an entity known to have one (its page exists).
+    [[nodiscard]]
+    EntityRecord&
+    _record_at(EntityId entityId) noexcept {
+        return _records[entityId / RECORD_PAGE_SIZE][entityId % RECORD_PAGE_SIZE];
+    }
+
+    // Returns nullptr when 'entityId' has no archetype components.
+    [[nodiscard]]
+    EntityRecord const*
+    _find_record(EntityId entityId) const noexcept {
+        auto const page = entityId / RECORD_PAGE_SIZE;
+        if (page >= _records.size() || _records[page] == nullptr) {
+            return nullptr;
+        }
+
+        auto const& record = _records[page][entityId % RECORD_PAGE_SIZE];
+        return record.archetype != nullptr ? &record : nullptr;
+    }
+
+    /*
+        Moves the entity of 'record' into the already pushed 'row' of
+        'destination', its components not in 'destination' are destroyed.
+    */
+    void
+    _move_entity(EntityRecord& record, Archetype* destination, size_t row) noexcept {
+        if (auto* source = record.archetype; source != nullptr) {
+            if (source->move_row(record.row, *destination, row)) {
+                _record_at(source->entity_at(record.row)).row = record.row;
+            }
+        }
+
+        record = { destination, row };
+    }
+
+    void
+    _erase_row(EntityRecord& record) noexcept {
+        auto* source = record.archetype;
 
-    struct Component {
-        virtual ~Component() = default;
+        if (source->destroy_row(record.row)) {
+            _record_at(source->entity_at(record.row)).row = record.row;
+        }
+
+        record = {};
+    }
+
+    // Archetype of 'source' plus 'info', created on first use.
+    [[nodiscard]]
+    Archetype*
+    _add_edge(Archetype* source, ComponentInfo const& info) {
+        if (source == nullptr) {
+            if (info.id >= _root_edges.size()) {
+                _root_edges.resize(info.id + 1);
+            }
+
+            auto& root = _root_edges[info.id];
+            if (root == nullptr) {
+                root = _archetype({ &info });
+            }
+
+            return root;
+        }
+
+        auto& edges = source->edges(info.id);
+        if (edges.add == nullptr) {
+            auto infos = source->infos();
+            infos.insert(std::upper_bound(infos.begin(), infos.end(), &info, [](auto* a, auto* b) { return a->id < b->id; }), &info);
+            edges.add = _archetype(std::move(infos));
+        }
+
+        return edges.add;
+    }
+
+    // Archetype of 'source' minus 'info', nullptr when nothing would be left.
+    [[nodiscard]]
+    Archetype*
+    _remove_edge(Archetype* source, ComponentInfo const& info) {
+        if (source->column_count() == 1) {
+            return nullptr;
+        }
+
+        auto& edges = source->edges(info.id);
+        if (edges.remove == nullptr) {
+            auto infos = source->infos();
+            std::erase(infos, &info);
+            edges.remove = _archetype(std::move(infos));
+        }
+
+        return edges.remove;
     }
 
-    class World {
-    private:
-        std::unordered_map<std::type_index, std::unordered_map<EntityId, std::shared_ptr<Component>>> _components;
+    [[nodiscard]]
+    Archetype*
+    _archetype(std::vector<ComponentInfo const*> infos) {
+        signature_t signature{};
+        for (auto* info: infos) {
+            signature.push_back(info->id);
+        }
 
-    public:
-        template <typename T>
-        void 
-        add_component(EntityId entityId, T component) {
-            _components[typeid(component)] = std::make_shared<T>(component);
+        auto& archetype = _archetype_index[signature];
+        if (archetype == nullptr) {
+            archetype = _archetypes.emplace_back(std::make_unique<Archetype>(std::move(infos))).get();
+
+            for (auto& query: _queries) {
+                if (query != nullptr) {
+                    query->archetype_created(*archetype);
+                }
+            }
         }
 
+        return archetype;
+    }
+};
+
+/*
+    Iterates every entity that has all of 'Ts'. The loop body is fully
+    typed: the callable is inlined and components come from plain pointers,
+    nothing in it goes through ComponentInfo or virtual calls.
+
+    - Archetype types only: the matching archetype tables are walked chunk
+      by chunk, one pointer increment per component.
+    - Sparse types only: the smallest pool drives, the others are probed.
+    - Mixed: whichever is smaller drives, the matching archetype rows or
+      the smallest sparse pool, and the other side is probed per entity.
+
+    'function' takes '(Ts&...)' or '(EntityId, Ts&...)', a split type
+    (see soa.hpp) comes as a soa_ref_t<T> instead of a 'T&'. Adding or
+    removing components while iterating is not allowed.
+
+    par_each() runs the same loop on a JobSystem: the matching chunks (or
+    the driving pool) are cut into tasks whose size adapts to the time
+    measured per chunk (or per entity), one estimate per callable type.
+
+    each_chunk() hands over whole chunks instead, as one span per type, or
+    a soa_spans_t<T> for split types (archetype types only, sparse types
+    are not contiguous per chunk).
+
+    A view built by a Query walks the tables cached by that query instead
+    of matching every archetype of the World.
+*/
+template <typename... Ts>
+class View {
+    static_assert(sizeof...(Ts) > 0, "A view needs at least one component type.");
+
+    static constexpr bool ANY_SPARSE = (is_sparse_component_v<Ts> || ...);
+    static constexpr bool ALL_SPARSE = (is_sparse_component_v<Ts> && ...);
+
+    using sequence_t = std::index_sequence_for<Ts...>;
+
+public:
+    using table_t = detail::CachedTable<sizeof...(Ts)>;
+
+private:
+    World* _world;
+    std::tuple<detail::source_t<Ts>...> _pools; // Sparse pools, nullptr for archetype types.
+    std::vector<table_t> const* _tables{};      // Cached matching tables, nullptr to match them now.
+
+public:
+    explicit View(World& world, std::vector<table_t> const* tables = nullptr) noexcept
+        : _world(&world), _pools(world._find_set<Ts>()...), _tables(tables) {}
+
+    // Whether entities of 'archetype' can match, sparse types are checked per entity.
+    [[nodiscard]]
+    static bool
+    matches(Archetype const& archetype) noexcept {
+        return ((is_sparse_component_v<Ts> || archetype.has(component_id<Ts>())) && ...);
+    }
+
+    // 'archetype' must match.
+    [[nodiscard]]
+    static table_t
+    table(Archetype& archetype) noexcept {
+        return { &archetype, { (is_sparse_component_v<Ts> ? Archetype::NO_COLUMN : archetype.column_of(component_id<Ts>()))... } };
+    }
+
+    template <typename F>
+    void
+    each(F&& function) {
+        if (!_pools_ready()) {
+            return;
+        }
+
+        if (_pool_driven()) {
+            _each_pool_driven(function, _smallest_pool(), sequence_t{});
+        }
+        else {
+            _each_archetype_driven(function);
+        }
+    }
+
+    /*
+        Same as each(), with 'function' called from several threads at
+        once (for different entities), so it must be safe to share.
+    */
+    template <typename F>
+    void
+    par_each(F&& function, JobSystem& jobs = JobSystem::global()) {
+        if (!_pools_ready()) {
+            return;
+        }
+
+        auto& grains = _grains<std::remove_cvref_t<F>>;
+
+        if (_pool_driven()) {
+            auto const entities = _smallest_pool();
+            detail::parallel_for(jobs, grains.entities, entities.size(), POOL_GRAIN, [&](size_t begin, size_t end) {
+                _each_pool_driven(function, entities.subspan(begin, end - begin), sequence_t{});
+            });
+
+            return;
+        }
+
+        // Every non-empty chunk is a work item, tasks take whole chunks.
+        std::vector<table_t> tables{};
+        _for_each_table([&](table_t const& table) {
+            if (table.archetype->size() != 0) {
+                tables.push_back(table);
+            }
+        });
+
+        std::vector<std::pair<uint32_t, uint32_t>> chunks{}; // Table, chunk.
+        for (uint32_t t{}; t < tables.size(); ++t) {
+            for (uint32_t c{}; c < tables[t].archetype->chunk_count(); ++c) {
+                chunks.emplace_back(t, c);
+            }
+        }
+
+        detail::parallel_for(jobs, grains.chunks, chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (auto i { begin }; i < end; ++i) {
+                auto const& table = tables[chunks[i].first];
+                _each_in_chunk(*table.archetype, chunks[i].second, table.columns.data(), function, sequence_t{});
+            }
+        });
+    }
+
+    /*
+        Calls 'function' once per non-empty matching chunk with the packed
+        arrays of that chunk, '(std::span<Ts>...)' or
+        '(std::span<EntityId const>, std::span<Ts>...)', split types as
+        soa_spans_t<T> (one span per field). Every span starts on a cache
+        line and all of them have the same size, so the body is a plain
+        loop over arrays the compiler can vectorize.
+    */
+    template <typename F>
+    void
+    each_chunk(F&& function) {
+        static_assert(!ANY_SPARSE, "each_chunk() only walks archetype types, sparse pools have no chunks.");
+
+        _for_each_table([&](table_t const& table) {
+            for (size_t chunk{}; chunk < table.archetype->chunk_count(); ++chunk) {
+                _chunk_spans(*table.archetype, chunk, table.columns.data(), function, sequence_t{});
+            }
+        });
+    }
+
+private:
+    // Driving entities per task until the first measurement.
+    static constexpr size_t POOL_GRAIN = 4096;
+
+    struct Grains {
+        detail::AdaptiveGrain chunks{};
+        detail::AdaptiveGrain entities{};
     };
 
-    
+    template <typename F>
+    static inline Grains _grains{};
+
+    // A sparse type nobody ever added matches no entity.
+    [[nodiscard]]
+    bool
+    _pools_ready() const noexcept {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return (_pool_ready<Ts>(std::get<Is>(_pools)) && ...);
+        }(sequence_t{});
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static bool
+    _pool_ready(detail::source_t<T> const& pool) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            return pool != nullptr;
+        }
+        else {
+            return true;
+        }
+    }
+
+    [[nodiscard]]
+    bool
+    _pool_driven() const noexcept {
+        if constexpr (ALL_SPARSE) {
+            return true;
+        }
+        else if constexpr (ANY_SPARSE) {
+            return _smallest_pool().size() < _archetype_rows();
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Calls 'function(table)' for every matching table.
+    template <typename F>
+    void
+    _for_each_table(F&& function) const {
+        if (_tables != nullptr) {
+            for (auto const& table: *_tables) {
+                function(table);
+            }
+
+            return;
+        }
+
+        for (auto const& archetype: _world->_archetypes) {
+            if (matches(*archetype)) {
+                function(table(*archetype));
+            }
+        }
+    }
+
+    [[nodiscard]]
+    size_t
+    _archetype_rows() const noexcept {
+        size_t rows{};
+        _for_each_table([&](table_t const& table) { rows += table.archetype->size(); });
+
+        return rows;
+    }
+
+    [[nodiscard]]
+    std::span<EntityId const>
+    _smallest_pool() const noexcept {
+        std::span<EntityId const> smallest{};
+        bool found{};
+
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (_consider_pool<Ts>(std::get<Is>(_pools), smallest, found), ...);
+        }(sequence_t{});
+
+        return smallest;
+    }
+
+    template <typename T>
+    static void
+    _consider_pool(detail::source_t<T> const& pool, std::span<EntityId const>& smallest, bool& found) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            if (!found || pool->size() < smallest.size()) {
+                smallest = pool->entities();
+                found = true;
+            }
+        }
+    }
+
+    template <typename F>
+    void
+    _each_archetype_driven(F& function) {
+        _for_each_table([&](table_t const& table) {
+            for (size_t chunk{}; chunk < table.archetype->chunk_count(); ++chunk) {
+                _each_in_chunk(*table.archetype, chunk, table.columns.data(), function, sequence_t{});
+            }
+        });
+    }
+
+    template <typename F, size_t... Is>
+    void
+    _each_in_chunk(Archetype& archetype, size_t chunk, size_t const* columns, F& function, std::index_sequence<Is...>) {
+        auto const count = archetype.chunk_size(chunk);
+        auto const* entities = archetype.chunk_entities(chunk);
+        std::tuple<detail::source_t<Ts>...> const sources { _chunk_source<Ts>(archetype, chunk, columns[Is], std::get<Is>(_pools))... };
+
+        for (size_t i{}; i < count; ++i) {
+            auto const entity = entities[i];
+
+            if constexpr (ANY_SPARSE) {
+                if (!((!is_sparse_component_v<Ts> || _has_sparse<Ts>(std::get<Is>(sources), entity)) && ...)) {
+                    continue;
+                }
+            }
+
+            _invoke(function, entity, _row_get<Ts>(std::get<Is>(sources), i, entity)...);
+        }
+    }
+
+    template <typename F, size_t... Is>
+    static void
+    _chunk_spans(Archetype& archetype, size_t chunk, size_t const* columns, F& function, std::index_sequence<Is...>) {
+        auto const count = archetype.chunk_size(chunk);
+        std::span<EntityId const> const entities { archetype.chunk_entities(chunk), count };
+
+        if constexpr (std::is_invocable_v<F&, std::span<EntityId const>, chunk_span_t<Ts>...>) {
+            function(entities, _column_span<Ts>(archetype, chunk, columns[Is], count)...);
+        }
+        else {
+            function(_column_span<Ts>(archetype, chunk, columns[Is], count)...);
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static chunk_span_t<T>
+    _column_span(Archetype& archetype, size_t chunk, size_t column, size_t count) noexcept {
+        if constexpr (SoaComponent<T>) {
+            return detail::soa_spans_at<T>(_chunk_fields<T>(archetype, chunk, column), count, detail::soa_sequence_t<T>{});
+        }
+        else {
+            return { std::assume_aligned<CACHE_LINE_SIZE>(static_cast<T*>(archetype.chunk_column(chunk, column))), count };
+        }
+    }
+
+    template <SoaComponent T>
+    [[nodiscard]]
+    static detail::soa_pointers_t<T>
+    _chunk_fields(Archetype& archetype, size_t chunk, size_t column) noexcept {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return detail::soa_pointers_t<T> {
+                std::assume_aligned<CACHE_LINE_SIZE>(static_cast<detail::soa_field_t<T, Is>*>(archetype.chunk_field(chunk, column, Is)))...
+            };
+        }(detail::soa_sequence_t<T>{});
+    }
+
+    template <typename F, size_t... Is>
+    void
+    _each_pool_driven(F& function, std::span<EntityId const> entities, std::index_sequence<Is...>) {
+        for (auto const entity: entities) {
+            if (!((!is_sparse_component_v<Ts> || _has_sparse<Ts>(std::get<Is>(_pools), entity)) && ...)) {
+                continue;
+            }
+
+            if constexpr (ALL_SPARSE) {
+                _invoke(function, entity, std::get<Is>(_pools)->get(entity)...);
+            }
+            else {
+                auto const* found = _world->_find_record(entity);
+                if (found == nullptr) {
+                    continue;
+                }
+
+                auto const& record = *found;
+                size_t const columns[] { (is_sparse_component_v<Ts> ? Archetype::NO_COLUMN : record.archetype->column_of(component_id<Ts>()))... };
+
+                if (!((is_sparse_component_v<Ts> || columns[Is] != Archetype::NO_COLUMN) && ...)) {
+                    continue;
+                }
+
+                _invoke(function, entity, _record_get<Ts>(std::get<Is>(_pools), *record.archetype, columns[Is], record.row, entity)...);
+            }
+        }
+    }
+
+    // Split types come as proxy values, passed on as lvalues like the references.
+    template <typename F, typename... Us>
+    static void
+    _invoke(F& function, EntityId entity, Us&&... components) {
+        if constexpr (std::is_invocable_v<F&, EntityId, Us&...>) {
+            function(entity, components...);
+        }
+        else {
+            function(components...);
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static detail::source_t<T>
+    _chunk_source(Archetype& archetype, size_t chunk, size_t column, detail::source_t<T> pool) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            return pool;
+        }
+        else if constexpr (SoaComponent<T>) {
+            return _chunk_fields<T>(archetype, chunk, column);
+        }
+        else {
+            return static_cast<T*>(archetype.chunk_column(chunk, column));
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static bool
+    _has_sparse(detail::source_t<T> const& source, EntityId entity) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            return source->contains(entity);
+        }
+        else {
+            return true;
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static component_ref_t<T>
+    _row_get(detail::source_t<T> const& source, size_t row, EntityId entity) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            return source->get(entity);
+        }
+        else if constexpr (SoaComponent<T>) {
+            return detail::soa_ref_at<T>(source, row, detail::soa_sequence_t<T>{});
+        }
+        else {
+            return source[row];
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static component_ref_t<T>
+    _record_get(detail::source_t<T> const& pool, Archetype& archetype, size_t column, size_t row, EntityId entity) noexcept {
+        if constexpr (is_sparse_component_v<T>) {
+            return pool->get(entity);
+        }
+        else if constexpr (SoaComponent<T>) {
+            return detail::soa_ref_at<T>(World::_soa_fields<T>(archetype, column, row), 0, detail::soa_sequence_t<T>{});
+        }
+        else {
+            return *static_cast<T*>(archetype.at(column, row));
+        }
+    }
+};
+
+/*
+    Persistent query over 'Ts', owned by the World (see World::query()).
+    It keeps the list of matching archetypes, with the column of every
+    type, and the World updates it only when an archetype is created or
+    pruned. Running it walks those tables and nothing else.
+*/
+template <typename... Ts>
+class Query final : public detail::QueryBase {
+public:
+    using view_t  = View<Ts...>;
+    using table_t = typename view_t::table_t;
+
+private:
+    World* _world;
+    std::vector<table_t> _tables{};
+
+public:
+    explicit Query(World& world)
+        : _world(&world) {
+        for (auto const& archetype: world._archetypes) {
+            archetype_created(*archetype);
+        }
+    }
+
+    [[nodiscard]] inline size_t table_count() const noexcept { return _tables.size(); }
+    [[nodiscard]] inline view_t view() const noexcept { return view_t { *_world, &_tables }; }
+
+    // Same as View::each(), over the cached tables.
+    template <typename F>
+    void
+    each(F&& function) {
+        view().each(std::forward<F>(function));
+    }
+
+    template <typename F>
+    void
+    par_each(F&& function, JobSystem& jobs = JobSystem::global()) {
+        view().par_each(std::forward<F>(function), jobs);
+    }
+
+    template <typename F>
+    void
+    each_chunk(F&& function) {
+        view().each_chunk(std::forward<F>(function));
+    }
+
+    void
+    archetype_created(Archetype& archetype) override {
+        if (view_t::matches(archetype)) {
+            _tables.push_back(view_t::table(archetype));
+        }
+    }
+
+    void
+    archetype_destroyed(Archetype& archetype) noexcept override {
+        std::erase_if(_tables, [&](table_t const& table) { return table.archetype == &archetype; });
+    }
+};
+
+/*
+    Owning group over sparse types 'Ts', owned by the World (see
+    World::group()). The group takes over the pools of 'Ts' and keeps them
+    co-sorted: the entities having all of 'Ts' sit at the front of every
+    pool, in the same order, so position 'i' of each dense array belongs to
+    the same entity. Iterating is a walk over parallel arrays, no lookups.
+
+    Adding a component swaps the entity into the packed front once it has
+    all of 'Ts', removing one swaps it out first, both O(1). Archetype
+    types need no group, an archetype packs its columns already.
+*/
+template <typename... Ts>
+class Group final : public detail::GroupBase {
+    static_assert(sizeof...(Ts) > 1, "A group needs at least two component types.");
+    static_assert((is_sparse_component_v<Ts> && ...), "Groups own sparse pools, every type must be sparse.");
+    static_assert((!std::is_const_v<Ts> && ...), "Group types are never const, see World::group().");
+
+    using sequence_t = std::index_sequence_for<Ts...>;
+
+    static constexpr size_t GRAIN = 4096; // Entities per task until the first measurement.
+
+    template <typename F>
+    static inline detail::AdaptiveGrain _grain{};
+
+    std::tuple<detail::set_t<Ts>*...> _sets;
+    size_t _size{}; // Entities packed at the front of every pool.
+
+public:
+    explicit Group(World& world)
+        : _sets(&world._pool<Ts>().set...) {
+        if (((world._pool<Ts>().group != nullptr) || ...)) {
+            throw std::logic_error("Failed to create group: A component type is already owned by another group.");
+        }
+
+        ((world._pool<Ts>().group = this), ...);
+
+        // Swapping only moves entities already looked at, one pass packs them all.
+        auto const& lead = *std::get<0>(_sets);
+        for (size_t i{}; i < lead.size(); ++i) {
+            added(lead.entities()[i]);
+        }
+    }
+
+    [[nodiscard]] inline size_t size() const noexcept { return _size; }
+    [[nodiscard]] inline bool empty() const noexcept { return _size == 0; }
+
+    // Packed entities, in the order of every owned pool.
+    [[nodiscard]] inline std::span<EntityId const> entities() const noexcept { return std::get<0>(_sets)->entities().first(_size); }
+
+    [[nodiscard]]
+    bool
+    contains(EntityId entity) const noexcept {
+        return std::get<0>(_sets)->index_of(entity) < _size;
+    }
+
+    // 'function' takes '(Ts&...)' or '(EntityId, Ts&...)', same rules as View::each().
+    template <typename F>
+    void
+    each(F&& function) {
+        if (_size != 0) {
+            _each(function, 0, _size, sequence_t{});
+        }
+    }
+
+    // Same as each(), the packed range split over 'jobs', see View::par_each().
+    template <typename F>
+    void
+    par_each(F&& function, JobSystem& jobs = JobSystem::global()) {
+        detail::parallel_for(jobs, _grain<std::remove_cvref_t<F>>, _size, GRAIN, [&](size_t begin, size_t end) {
+            _each(function, begin, end, sequence_t{});
+        });
+    }
+
+    /*
+        Calls 'function' once with the packed range of every pool,
+        '(std::span<Ts>...)' or '(std::span<EntityId const>, std::span<Ts>...)',
+        see View::each_chunk(). Tags store no values, so they cannot be part
+        of such a group.
+    */
+    template <typename F>
+    void
+    each_chunk(F&& function) {
+        static_assert((detail::set_t<Ts>::STORES_VALUES && ...), "each_chunk() needs every type to store values, tags have no array.");
+
+        if (_size == 0) {
+            return;
+        }
+
+        if constexpr (std::is_invocable_v<F&, std::span<EntityId const>, std::span<Ts>...>) {
+            function(entities(), std::get<detail::set_t<Ts>*>(_sets)->values().first(_size)...);
+        }
+        else {
+            function(std::get<detail::set_t<Ts>*>(_sets)->values().first(_size)...);
+        }
+    }
+
+    void
+    added(EntityId entity) noexcept override {
+        if (_owns_all(entity, sequence_t{}) && !contains(entity)) {
+            (_swap_into<Ts>(entity, _size), ...);
+            ++_size;
+        }
+    }
+
+    void
+    removing(EntityId entity) noexcept override {
+        if (_owns_all(entity, sequence_t{}) && contains(entity)) {
+            --_size;
+            (_swap_into<Ts>(entity, _size), ...);
+        }
+    }
+
+private:
+    template <size_t... Is>
+    [[nodiscard]]
+    bool
+    _owns_all(EntityId entity, std::index_sequence<Is...>) const noexcept {
+        return (std::get<Is>(_sets)->contains(entity) && ...);
+    }
+
+    template <typename T>
+    void
+    _swap_into(EntityId entity, size_t position) noexcept {
+        auto& set = *std::get<detail::set_t<T>*>(_sets);
+        set.swap_at(set.index_of(entity), static_cast<typename detail::set_t<T>::index_t>(position));
+    }
+
+    template <typename F, size_t... Is>
+    void
+    _each(F& function, size_t begin, size_t end, std::index_sequence<Is...>) {
+        auto const* entities = std::get<0>(_sets)->entities().data();
+        auto const bases = std::tuple { _base<Ts>(entities[0])... };
+
+        for (auto i { begin }; i < end; ++i) {
+            if constexpr (std::is_invocable_v<F&, EntityId, Ts&...>) {
+                function(entities[i], _at<Ts>(std::get<Is>(bases), i)...);
+            }
+            else {
+                function(_at<Ts>(std::get<Is>(bases), i)...);
+            }
+        }
+    }
+
+    // First packed value of 'T', or the instance shared by every entity of a tag.
+    template <typename T>
+    [[nodiscard]]
+    T*
+    _base(EntityId first) noexcept {
+        auto& set = *std::get<detail::set_t<T>*>(_sets);
+
+        if constexpr (detail::set_t<T>::STORES_VALUES) {
+            return set.values().data();
+        }
+        else {
+            return &set.get(first);
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]]
+    static T&
+    _at(T* base, [[maybe_unused]] size_t i) noexcept {
+        if constexpr (detail::set_t<T>::STORES_VALUES) {
+            return base[i];
+        }
+        else {
+            return *base;
+        }
+    }
+};
+
 } // namespace vecs
@@ -0,0 +1,454 @@
+#pragma once
+
+// std
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <cassert>
+
+#include "config.hpp"
+
+namespace vecs {
+
+namespace detail {
+
+/*
+    Chase-Lev work-stealing deque. The owner thread pushes and pops at the
+    bottom (LIFO, the freshest and cache-warm work), any other thread
+    steals from the top (FIFO, the oldest and usually biggest work). Only
+    a steal racing the pop of the last item needs a CAS.
+
+    The ring grows by doubling, old rings are kept until the deque dies
+    since a thief may still be reading one.
+*/
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_pointer_v<T>, "The deque hands out pointers, nullptr meaning empty.");
+
+    struct Ring {
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Ring(int64_t capacity)
+            : mask(capacity - 1), slots(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(capacity))) {}
+
+        [[nodiscard]] int64_t capacity() const noexcept { return mask + 1; }
+        [[nodiscard]] T load(int64_t i) const noexcept { return slots[i & mask].load(std::memory_order_relaxed); }
+        void store(int64_t i, T item) noexcept { slots[i & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> _top{};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> _bottom{};
+    std::atomic<Ring*> _ring{};
+    std::vector<std::unique_ptr<Ring>> _rings{}; // Every ring ever used, owner only.
+
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        _ring.store(_rings.emplace_back(std::make_unique<Ring>(capacity)).get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(WorkStealingDeque const&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque const&) = delete;
+
+    // Owner only.
+    void
+    push(T item) {
+        auto const bottom = _bottom.load(std::memory_order_relaxed);
+        auto const top = _top.load(std::memory_order_acquire);
+        auto* ring = _ring.load(std::memory_order_relaxed);
+
+        if (bottom - top >= ring->capacity()) {
+            ring = _grow(ring, top, bottom);
+        }
+
+        ring->store(bottom, item);
+        _bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only, nullptr when empty.
+    [[nodiscard]]
+    T
+    pop() noexcept {
+        auto const bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        auto* ring = _ring.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_seq_cst);
+
+        auto top = _top.load(std::memory_order_seq_cst);
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto item = ring->load(bottom);
+
+        if (top == bottom) { // Last item, race the thieves for it.
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    // Any thread, nullptr when empty or when another thread won the item.
+    [[nodiscard]]
+    T
+    steal() noexcept {
+        auto top = _top.load(std::memory_order_seq_cst);
+        auto const bottom = _bottom.load(std::memory_order_seq_cst);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        auto const item = _ring.load(std::memory_order_acquire)->load(top);
+
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+    [[nodiscard]]
+    bool
+    empty() const noexcept {
+        return _top.load(std::memory_order_relaxed) >= _bottom.load(std::memory_order_relaxed);
+    }
+
+private:
+    Ring*
+    _grow(Ring* ring, int64_t top, int64_t bottom) {
+        auto* bigger = _rings.emplace_back(std::make_unique<Ring>(ring->capacity() * 2)).get();
+
+        for (auto i { top }; i < bottom; ++i) {
+            bigger->store(i, ring->load(i));
+        }
+
+        _ring.store(bigger, std::memory_order_release);
+
+        return bigger;
+    }
+};
+
+} // namespace detail
+
+class TaskGroup;
+
+/*
+    Work-stealing thread pool, the one execution backend of vecs: the
+    Scheduler, parallel iteration and bulk operations all submit to it.
+    Use global(), one pool per process sized to the machine, rather than
+    spawning threads per subsystem.
+
+    - Every worker owns a Chase-Lev deque. Jobs spawned by a worker go to
+      its own deque, jobs from other threads to a shared injection queue.
+    - An idle worker tries its deque, the injection queue, then steals
+      from the other workers, starting at a random one.
+    - Workers with nothing to do park on an atomic epoch, submitting bumps
+      it and wakes a parked worker only when there is one.
+
+    Jobs are grouped in TaskGroups, see there.
+*/
+class JobSystem {
+public:
+    static constexpr size_t NOT_A_WORKER = std::numeric_limits<size_t>::max();
+
+private:
+    struct Job {
+        std::function<void()> function;
+        TaskGroup* group;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Worker {
+        detail::WorkStealingDeque<Job*> deque{};
+        std::thread thread{};
+    };
+
+    std::vector<std::unique_ptr<Worker>> _workers{};
+
+    std::mutex _injected_mutex{};
+    std::deque<Job*> _injected{};
+    std::atomic<size_t> _injected_count{};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> _epoch{};
+    std::atomic<uint32_t> _sleeping{};
+    std::atomic<bool> _stopping{};
+
+    // Which worker of which system the calling thread is.
+    static inline thread_local JobSystem const* _current_system{};
+    static inline thread_local size_t _current_index { NOT_A_WORKER };
+
+    friend class TaskGroup;
+
+public:
+    explicit JobSystem(size_t worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+        worker_count = std::max<size_t>(worker_count, 1);
+        _workers.reserve(worker_count);
+
+        for (size_t i{}; i < worker_count; ++i) {
+            _workers.push_back(std::make_unique<Worker>());
+        }
+
+        // Started once every deque exists, workers steal from each other right away.
+        for (size_t i{}; i < worker_count; ++i) {
+            _workers[i]->thread = std::thread { [this, i] { _work(i); } };
+        }
+    }
+
+    JobSystem(JobSystem const&) = delete;
+    JobSystem& operator=(JobSystem const&) = delete;
+
+    // Every TaskGroup must have been waited for.
+    ~JobSystem() {
+        _stopping.store(true, std::memory_order_seq_cst);
+        _epoch.fetch_add(1, std::memory_order_seq_cst);
+        _epoch.notify_all();
+
+        for (auto& worker: _workers) {
+            worker->thread.join();
+        }
+    }
+
+    // The process wide pool, one worker per hardware thread.
+    [[nodiscard]]
+    static JobSystem&
+    global() {
+        static JobSystem system{};
+        return system;
+    }
+
+    [[nodiscard]] inline size_t worker_count() const noexcept { return _workers.size(); }
+
+    // Index of the calling thread among the workers of this system, NOT_A_WORKER for any other thread.
+    [[nodiscard]]
+    size_t
+    worker_index() const noexcept {
+        return _current_system == this ? _current_index : NOT_A_WORKER;
+    }
+
+private:
+    void
+    _submit(Job* job) {
+        if (auto const index = worker_index(); index != NOT_A_WORKER) {
+            _workers[index]->deque.push(job);
+        }
+        else {
+            std::scoped_lock lock { _injected_mutex };
+            _injected.push_back(job);
+            _injected_count.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        _epoch.fetch_add(1, std::memory_order_seq_cst);
+
+        if (_sleeping.load(std::memory_order_seq_cst) != 0) {
+            _epoch.notify_one();
+        }
+    }
+
+    [[nodiscard]]
+    Job*
+    _find(size_t index) noexcept {
+        if (auto* job = _workers[index]->deque.pop()) {
+            return job;
+        }
+
+        if (_injected_count.load(std::memory_order_seq_cst) != 0) {
+            std::scoped_lock lock { _injected_mutex };
+
+            if (!_injected.empty()) {
+                auto* job = _injected.front();
+                _injected.pop_front();
+                _injected_count.fetch_sub(1, std::memory_order_relaxed);
+
+                return job;
+            }
+        }
+
+        // xorshift, just to spread the thieves over the victims.
+        static thread_local uint32_t seed { static_cast<uint32_t>(index) * 2654435761u + 1 };
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        auto const count = _workers.size();
+        for (size_t i{}, victim = seed % count; i < count; ++i, victim = (victim + 1) % count) {
+            if (victim == index) {
+                continue;
+            }
+
+            if (auto* job = _workers[victim]->deque.steal()) {
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void _execute(Job* job) noexcept;
+
+    void
+    _work(size_t index) {
+        _current_system = this;
+        _current_index = index;
+
+        while (true) {
+            if (auto* job = _find(index)) {
+                _execute(job);
+                continue;
+            }
+
+            // Read the epoch before the last look, a submit after it changes the epoch and wait() returns.
+            auto const epoch = _epoch.load(std::memory_order_seq_cst);
+            _sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+            if (auto* job = _find(index)) {
+                _sleeping.fetch_sub(1, std::memory_order_relaxed);
+                _execute(job);
+                continue;
+            }
+
+            if (_stopping.load(std::memory_order_seq_cst)) {
+                _sleeping.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+
+            _epoch.wait(epoch, std::memory_order_seq_cst);
+            _sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+/*
+    Set of jobs that can be waited for together. Jobs may run more jobs
+    in their own group (or any other), nesting is fine.
+
+    wait() returns once every job of the group is done and rethrows the
+    first exception one of them threw. Called from a worker it runs other
+    jobs meanwhile, so waiting inside a job never deadlocks the pool;
+    called from any other thread it parks.
+
+    The destructor waits too (dropping exceptions), a group must not be
+    destroyed while its jobs can still touch it.
+*/
+class TaskGroup {
+private:
+    JobSystem* _system;
+    std::atomic<size_t> _pending{};
+    std::atomic<size_t> _finishing{}; // Jobs between their last decrement and their last touch of the group.
+    std::atomic<bool> _failed{};
+    std::exception_ptr _error{};
+
+    friend class JobSystem;
+
+public:
+    explicit TaskGroup(JobSystem& system = JobSystem::global()) noexcept
+        : _system(&system) {}
+
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+
+    ~TaskGroup() {
+        _wait_all();
+    }
+
+    [[nodiscard]] inline JobSystem& system() const noexcept { return *_system; }
+
+    template <typename F>
+    void
+    run(F&& function) {
+        auto job = std::make_unique<JobSystem::Job>(JobSystem::Job { std::function<void()> { std::forward<F>(function) }, this });
+        _pending.fetch_add(1, std::memory_order_relaxed);
+
+        // The queues own the job once _submit() returns, until then it is ours.
+        try {
+            _system->_submit(job.get());
+        }
+        catch (...) {
+            _finish();
+            throw;
+        }
+
+        job.release();
+    }
+
+    void
+    wait() {
+        _wait_all();
+
+        if (_failed.load(std::memory_order_acquire)) {
+            _failed.store(false, std::memory_order_relaxed);
+            std::rethrow_exception(std::exchange(_error, nullptr));
+        }
+    }
+
+private:
+    void
+    _wait_all() noexcept {
+        if (auto const index = _system->worker_index(); index != JobSystem::NOT_A_WORKER) {
+            while (_pending.load(std::memory_order_acquire) != 0) {
+                if (auto* job = _system->_find(index)) {
+                    _system->_execute(job);
+                }
+                else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        else {
+            for (auto pending = _pending.load(std::memory_order_acquire); pending != 0; pending = _pending.load(std::memory_order_acquire)) {
+                _pending.wait(pending, std::memory_order_acquire);
+            }
+        }
+
+        while (_finishing.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void
+    _fail(std::exception_ptr error) noexcept {
+        if (!_failed.exchange(true, std::memory_order_acq_rel)) {
+            _error = std::move(error);
+        }
+    }
+
+    void
+    _finish() noexcept {
+        _finishing.fetch_add(1, std::memory_order_relaxed);
+
+        if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _pending.notify_all();
+        }
+
+        _finishing.fetch_sub(1, std::memory_order_release);
+    }
+};
+
+inline void
+JobSystem::_execute(Job* job) noexcept {
+    std::unique_ptr<Job> owned { job };
+
+    try {
+        owned->function();
+    }
+    catch (...) {
+        owned->group->_fail(std::current_exception());
+    }
+
+    owned->group->_finish();
+}
+
+} // namespace vecs
@@ -0,0 +1,92 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+
+#include "job_system.hpp"
+
+namespace vecs {
+
+namespace detail {
+
+/*
+    Grain size learned from measurement: tasks time how long their items
+    took and the grain becomes the number of items that fit TARGET_NS, so
+    tasks stay big enough to pay for scheduling and small enough to
+    balance. The estimate is a moving average, concurrent updates may
+    overwrite each other, which only loses a sample.
+*/
+class AdaptiveGrain {
+public:
+    static constexpr uint64_t TARGET_NS = 50'000;
+
+private:
+    static constexpr uint64_t SCALE = 1024; // Fixed point, nanoseconds per 1024 items.
+
+    std::atomic<uint64_t> _scaled_ns_per_item{}; // 0 until the first sample.
+
+public:
+    // Items per task, 'fallback' until something was measured.
+    [[nodiscard]]
+    size_t
+    items(size_t fallback) const noexcept {
+        auto const cost = _scaled_ns_per_item.load(std::memory_order_relaxed);
+        return cost == 0 ? fallback : static_cast<size_t>(std::max<uint64_t>(TARGET_NS * SCALE / cost, 1));
+    }
+
+    void
+    record(size_t items, uint64_t ns) noexcept {
+        auto const sample = std::max<uint64_t>(ns * SCALE / std::max<size_t>(items, 1), 1);
+        auto const old = _scaled_ns_per_item.load(std::memory_order_relaxed);
+
+        _scaled_ns_per_item.store(old == 0 ? sample : (old * 3 + sample) / 4, std::memory_order_relaxed);
+    }
+
+    template <typename F>
+    void
+    measure(size_t items, F&& body) {
+        auto const start = std::chrono::steady_clock::now();
+        body();
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+
+        record(items, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+};
+
+/*
+    Calls 'body(begin, end)' over [0, count) split in 'grain' sized ranges,
+    as jobs of 'jobs'. The calling thread runs the last range itself and
+    returns once every range is done, rethrowing the first error.
+*/
+template <typename F>
+void
+parallel_for(JobSystem& jobs, AdaptiveGrain& grain, size_t count, size_t fallback, F&& body) {
+    if (count == 0) {
+        return;
+    }
+
+    auto const step = grain.items(fallback);
+
+    if (count <= step || jobs.worker_count() == 1) {
+        grain.measure(count, [&] { body(size_t{}, count); });
+        return;
+    }
+
+    TaskGroup group { jobs };
+    auto begin = size_t{};
+
+    for (; count - begin > step; begin += step) {
+        group.run([&, begin] { grain.measure(step, [&] { body(begin, begin + step); }); });
+    }
+
+    // On error the group destructor still waits for the jobs in flight.
+    grain.measure(count - begin, [&] { body(begin, count); });
+    group.wait();
+}
+
+} // namespace detail
+
+} // namespace vecs
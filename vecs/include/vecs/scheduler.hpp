@@ -0,0 +1,289 @@
+#pragma once
+
+// std
+#include <vector>
+#include <string>
+#include <span>
+#include <atomic>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <stdint.h>
+
+#include "component.hpp"
+#include "entities.hpp"
+#include "command_buffer.hpp"
+#include "job_system.hpp"
+
+namespace vecs {
+
+// Component types a system only reads, see Scheduler::add_system().
+template <typename... Ts>
+struct Reads {};
+
+// Component types a system writes (and may read).
+template <typename... Ts>
+struct Writes {};
+
+namespace detail {
+
+template <typename T>
+inline constexpr bool is_access_list_v = false;
+
+template <typename... Ts>
+inline constexpr bool is_access_list_v<Reads<Ts...>> = true;
+
+template <typename... Ts>
+inline constexpr bool is_access_list_v<Writes<Ts...>> = true;
+
+// Appends the ids of 'T' when it is a 'TKind<...>' list, nothing otherwise.
+template <template <typename...> typename TKind, typename T>
+struct access_types {
+    static void append(std::vector<ComponentId>&) {}
+};
+
+template <template <typename...> typename TKind, typename... Ts>
+struct access_types<TKind, TKind<Ts...>> {
+    static void
+    append(std::vector<ComponentId>& ids) {
+        (ids.push_back(component_id<std::remove_const_t<Ts>>()), ...);
+    }
+};
+
+// Sorted ids of every type listed in the 'TKind' lists of 'TAccess'.
+template <template <typename...> typename TKind, typename... TAccess>
+[[nodiscard]]
+std::vector<ComponentId>
+access_ids() {
+    std::vector<ComponentId> ids{};
+    (access_types<TKind, TAccess>::append(ids), ...);
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    return ids;
+}
+
+[[nodiscard]]
+inline bool
+intersects(std::vector<ComponentId> const& a, std::vector<ComponentId> const& b) noexcept {
+    auto i = a.begin();
+    auto j = b.begin();
+
+    while (i != a.end() && j != b.end()) {
+        if (*i == *j) {
+            return true;
+        }
+
+        *i < *j ? ++i : ++j;
+    }
+
+    return false;
+}
+
+} // namespace detail
+
+// Reads<...> or Writes<...>.
+template <typename T>
+concept AccessList = detail::is_access_list_v<T>;
+
+using SystemId = uint32_t;
+
+/*
+    Runs systems over one World on a JobSystem. Every system declares the
+    component types it reads and writes, two systems conflict when one of
+    them writes a type the other reads or writes. A system waits for every
+    conflicting system registered before it, the others run at the same
+    time, so the dependency graph is a DAG that keeps registration order
+    wherever it matters.
+
+    Inside a system:
+    - touch only the declared types, through views (World::query() builds
+      its cache on the first call, make that call before run());
+    - make structural changes through the CommandBuffer it is given, one
+      per system. The buffers are applied once every system of the frame
+      is done, in registration order, so the result (created entity ids
+      included) does not depend on which worker ran what.
+
+    A system takes '(World&)' or '(World&, CommandBuffer&)'.
+*/
+class Scheduler {
+public:
+    using system_t = std::function<void(World&, CommandBuffer&)>;
+
+private:
+    // Own cache lines, systems running together record into their buffers without false sharing.
+    struct alignas(CACHE_LINE_SIZE) System {
+        std::string name;
+        system_t function;
+        std::vector<ComponentId> reads;
+        std::vector<ComponentId> writes;
+        std::vector<SystemId> dependencies{}; // Earlier conflicting systems.
+        std::vector<SystemId> dependents{};   // Later conflicting systems.
+        CommandBuffer commands{};
+    };
+
+    // State of the frame being run, shared with the jobs.
+    struct Frame {
+        World* world{};
+        TaskGroup* group{};
+        std::vector<std::atomic<uint32_t>> waiting{}; // Unfinished dependencies, per system.
+        std::atomic<bool> failed{};
+    };
+
+    JobSystem* _jobs;
+    std::vector<System> _systems{};
+    Frame _frame{};
+
+public:
+    explicit Scheduler(JobSystem& jobs = JobSystem::global())
+        : _jobs(&jobs) {}
+
+    Scheduler(Scheduler const&) = delete;
+    Scheduler& operator=(Scheduler const&) = delete;
+
+    [[nodiscard]] inline size_t thread_count() const noexcept { return _jobs->worker_count(); }
+    [[nodiscard]] inline size_t system_count() const noexcept { return _systems.size(); }
+    [[nodiscard]] inline std::string const& name(SystemId system) const noexcept { return _systems[system].name; }
+
+    // Systems 'system' waits for, all registered before it.
+    [[nodiscard]]
+    std::span<SystemId const>
+    dependencies(SystemId system) const noexcept {
+        return _systems[system].dependencies;
+    }
+
+    /*
+        Registers 'function' with its access, e.g.
+        add_system<Reads<Velocity>, Writes<Position>>("move", ...). The
+        lists come in any order and any number, a type listed in both is
+        written.
+    */
+    template <AccessList... TAccess, typename F>
+    SystemId
+    add_system(std::string name, F&& function) {
+        auto const id = static_cast<SystemId>(_systems.size());
+        auto& system = _systems.emplace_back(System {
+            std::move(name),
+            _wrap(std::forward<F>(function)),
+            detail::access_ids<Reads, TAccess...>(),
+            detail::access_ids<Writes, TAccess...>(),
+        });
+
+        for (SystemId other{}; other < id; ++other) {
+            if (_conflict(_systems[other], system)) {
+                system.dependencies.push_back(other);
+                _systems[other].dependents.push_back(id);
+            }
+        }
+
+        return id;
+    }
+
+    /*
+        Runs every system once, as parallel as the graph allows, then
+        applies the command buffers. Returns when all of it is done. The
+        first exception thrown by a system is rethrown here, systems not
+        started yet are skipped and the commands are dropped.
+    */
+    void
+    run(World& world) {
+        if (_systems.empty()) {
+            return;
+        }
+
+        TaskGroup group { *_jobs };
+
+        _frame.world = &world;
+        _frame.group = &group;
+        _frame.waiting = std::vector<std::atomic<uint32_t>>(_systems.size());
+        _frame.failed = false;
+
+        for (SystemId id{}; id < _systems.size(); ++id) {
+            _frame.waiting[id] = static_cast<uint32_t>(_systems[id].dependencies.size());
+        }
+
+        try {
+            for (SystemId id{}; id < _systems.size(); ++id) {
+                if (_systems[id].dependencies.empty()) {
+                    _submit(id);
+                }
+            }
+
+            group.wait();
+        }
+        catch (...) {
+            // Nothing may still be recording when the buffers are dropped.
+            _frame.failed = true;
+            try { group.wait(); } catch (...) {}
+
+            for (auto& system: _systems) {
+                system.commands.clear();
+            }
+
+            throw;
+        }
+
+        for (auto& system: _systems) {
+            system.commands.apply(world);
+        }
+    }
+
+private:
+    template <typename F>
+    [[nodiscard]]
+    static system_t
+    _wrap(F&& function) {
+        if constexpr (std::is_invocable_v<F&, World&, CommandBuffer&>) {
+            return std::forward<F>(function);
+        }
+        else {
+            return [function = std::forward<F>(function)](World& world, CommandBuffer&) mutable { function(world); };
+        }
+    }
+
+    [[nodiscard]]
+    static bool
+    _conflict(System const& a, System const& b) noexcept {
+        return detail::intersects(a.writes, b.writes)
+            || detail::intersects(a.writes, b.reads)
+            || detail::intersects(a.reads, b.writes);
+    }
+
+    void
+    _submit(SystemId id) {
+        _frame.group->run([this, id] { _execute(id); });
+    }
+
+    // The group keeps the first error, dependents still count down but skip their body.
+    void
+    _execute(SystemId id) {
+        auto& system = _systems[id];
+
+        if (!_frame.failed.load(std::memory_order_relaxed)) {
+            try {
+                system.function(*_frame.world, system.commands);
+            }
+            catch (...) {
+                _frame.failed = true;
+                _release(system);
+                throw;
+            }
+        }
+
+        _release(system);
+    }
+
+    // Release order publishes the writes of 'system' to the dependents it unlocks.
+    void
+    _release(System const& system) {
+        for (auto const dependent: system.dependents) {
+            if (_frame.waiting[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                _submit(dependent);
+            }
+        }
+    }
+};
+
+} // namespace vecs
@@ -0,0 +1,328 @@
+#pragma once
+
+// std
+#include <span>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <bit>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include <cassert>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define VECS_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#else
+    #define VECS_SIMD_X86 0
+#endif
+
+/*
+    Code between VECS_SIMD_TARGET_BEGIN(isa) and VECS_SIMD_TARGET_END is
+    compiled for 'isa' whatever the compiler flags, the dispatcher only
+    calls it once the CPU is known to support it. MSVC needs nothing, its
+    intrinsics are always available.
+*/
+#if defined(__clang__)
+    #define VECS_SIMD_PRAGMA(x) _Pragma(#x)
+    #define VECS_SIMD_TARGET_BEGIN(isa) VECS_SIMD_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+    #define VECS_SIMD_TARGET_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+    #define VECS_SIMD_PRAGMA(x) _Pragma(#x)
+    #define VECS_SIMD_TARGET_BEGIN(isa) _Pragma("GCC push_options") VECS_SIMD_PRAGMA(GCC target(isa))
+    #define VECS_SIMD_TARGET_END _Pragma("GCC pop_options")
+#else
+    #define VECS_SIMD_TARGET_BEGIN(isa)
+    #define VECS_SIMD_TARGET_END
+#endif
+
+/*
+    Batch kernels for the usual transform work, over SoA spans: the
+    arrays each_chunk() hands out, split components included (see
+    soa.hpp), convert to the span bundles below when their fields are
+    named x, y, z (and w).
+
+    Every kernel exists as scalar, SSE4.2 and AVX2 + FMA code, the best one
+    the CPU supports is picked at runtime, so the library needs no
+    special compiler flags. Results may differ in the last bits between
+    levels (FMA rounds once).
+
+        world.view<Position, Velocity const>().each_chunk([&](auto position, auto velocity) {
+            vecs::simd::integrate(position, velocity, dt);
+        });
+*/
+namespace vecs::simd {
+
+enum class Level { Scalar, SSE42, AVX2 };
+
+// Span bundles, one span per component of the value, all of the same size.
+template <typename T>
+struct Vec3Span {
+    std::span<T> x, y, z;
+
+    Vec3Span(std::span<T> x, std::span<T> y, std::span<T> z) noexcept : x(x), y(y), z(z) {}
+
+    template <typename U>
+    requires requires (U const& u) { std::span<T> { u.x }; std::span<T> { u.y }; std::span<T> { u.z }; }
+    Vec3Span(U const& spans) noexcept : x(spans.x), y(spans.y), z(spans.z) {}
+
+    [[nodiscard]] inline size_t size() const noexcept { return x.size(); }
+    [[nodiscard]] inline bool valid() const noexcept { return y.size() == x.size() && z.size() == x.size(); }
+};
+
+template <typename T>
+struct QuatSpan {
+    std::span<T> x, y, z, w;
+
+    QuatSpan(std::span<T> x, std::span<T> y, std::span<T> z, std::span<T> w) noexcept : x(x), y(y), z(z), w(w) {}
+
+    template <typename U>
+    requires requires (U const& u) { std::span<T> { u.x }; std::span<T> { u.y }; std::span<T> { u.z }; std::span<T> { u.w }; }
+    QuatSpan(U const& spans) noexcept : x(spans.x), y(spans.y), z(spans.z), w(spans.w) {}
+
+    [[nodiscard]] inline size_t size() const noexcept { return x.size(); }
+    [[nodiscard]] inline bool valid() const noexcept { return y.size() == x.size() && z.size() == x.size() && w.size() == x.size(); }
+};
+
+// Column-major 4x4 matrices, element 'm[column * 4 + row]'.
+struct Mat4Span {
+    std::array<std::span<float>, 16> m;
+
+    [[nodiscard]] inline size_t size() const noexcept { return m[0].size(); }
+
+    [[nodiscard]]
+    bool
+    valid() const noexcept {
+        return std::all_of(m.begin(), m.end(), [&](auto const& column) { return column.size() == m[0].size(); });
+    }
+};
+
+namespace detail {
+
+// One float per register, also runs the tail of the wider kernels.
+struct ScalarOps {
+    static constexpr size_t WIDTH = 1;
+
+    [[nodiscard]] static inline float load(float const* p) noexcept { return *p; }
+    static inline void store(float* p, float a) noexcept { *p = a; }
+    [[nodiscard]] static inline float set1(float a) noexcept { return a; }
+    [[nodiscard]] static inline float add(float a, float b) noexcept { return a + b; }
+    [[nodiscard]] static inline float sub(float a, float b) noexcept { return a - b; }
+    [[nodiscard]] static inline float mul(float a, float b) noexcept { return a * b; }
+    [[nodiscard]] static inline float div(float a, float b) noexcept { return a / b; }
+    [[nodiscard]] static inline float max(float a, float b) noexcept { return a > b ? a : b; }
+    [[nodiscard]] static inline float sqrt(float a) noexcept { return std::sqrt(a); }
+    [[nodiscard]] static inline float fmadd(float a, float b, float c) noexcept { return a * b + c; }
+    [[nodiscard]] static inline bool less_equal(float a, float b) noexcept { return a <= b; }
+    [[nodiscard]] static inline uint32_t mask_bits(bool mask) noexcept { return mask ? 1u : 0u; }
+};
+
+struct ScalarKernels {
+    using V = ScalarOps;
+    #include "simd_kernels.inl"
+};
+
+#if VECS_SIMD_X86
+
+VECS_SIMD_TARGET_BEGIN("sse4.2")
+
+struct Sse42Ops {
+    static constexpr size_t WIDTH = 4;
+
+    [[nodiscard]] static inline __m128 load(float const* p) noexcept { return _mm_loadu_ps(p); }
+    static inline void store(float* p, __m128 a) noexcept { _mm_storeu_ps(p, a); }
+    [[nodiscard]] static inline __m128 set1(float a) noexcept { return _mm_set1_ps(a); }
+    [[nodiscard]] static inline __m128 add(__m128 a, __m128 b) noexcept { return _mm_add_ps(a, b); }
+    [[nodiscard]] static inline __m128 sub(__m128 a, __m128 b) noexcept { return _mm_sub_ps(a, b); }
+    [[nodiscard]] static inline __m128 mul(__m128 a, __m128 b) noexcept { return _mm_mul_ps(a, b); }
+    [[nodiscard]] static inline __m128 div(__m128 a, __m128 b) noexcept { return _mm_div_ps(a, b); }
+    [[nodiscard]] static inline __m128 max(__m128 a, __m128 b) noexcept { return _mm_max_ps(a, b); }
+    [[nodiscard]] static inline __m128 sqrt(__m128 a) noexcept { return _mm_sqrt_ps(a); }
+    [[nodiscard]] static inline __m128 fmadd(__m128 a, __m128 b, __m128 c) noexcept { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    [[nodiscard]] static inline __m128 less_equal(__m128 a, __m128 b) noexcept { return _mm_cmple_ps(a, b); }
+    [[nodiscard]] static inline uint32_t mask_bits(__m128 mask) noexcept { return static_cast<uint32_t>(_mm_movemask_ps(mask)); }
+};
+
+struct Sse42Kernels {
+    using V = Sse42Ops;
+    #include "simd_kernels.inl"
+};
+
+VECS_SIMD_TARGET_END
+
+VECS_SIMD_TARGET_BEGIN("avx2,fma")
+
+struct Avx2Ops {
+    static constexpr size_t WIDTH = 8;
+
+    [[nodiscard]] static inline __m256 load(float const* p) noexcept { return _mm256_loadu_ps(p); }
+    static inline void store(float* p, __m256 a) noexcept { _mm256_storeu_ps(p, a); }
+    [[nodiscard]] static inline __m256 set1(float a) noexcept { return _mm256_set1_ps(a); }
+    [[nodiscard]] static inline __m256 add(__m256 a, __m256 b) noexcept { return _mm256_add_ps(a, b); }
+    [[nodiscard]] static inline __m256 sub(__m256 a, __m256 b) noexcept { return _mm256_sub_ps(a, b); }
+    [[nodiscard]] static inline __m256 mul(__m256 a, __m256 b) noexcept { return _mm256_mul_ps(a, b); }
+    [[nodiscard]] static inline __m256 div(__m256 a, __m256 b) noexcept { return _mm256_div_ps(a, b); }
+    [[nodiscard]] static inline __m256 max(__m256 a, __m256 b) noexcept { return _mm256_max_ps(a, b); }
+    [[nodiscard]] static inline __m256 sqrt(__m256 a) noexcept { return _mm256_sqrt_ps(a); }
+    [[nodiscard]] static inline __m256 fmadd(__m256 a, __m256 b, __m256 c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+    [[nodiscard]] static inline __m256 less_equal(__m256 a, __m256 b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    [[nodiscard]] static inline uint32_t mask_bits(__m256 mask) noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(mask)); }
+};
+
+struct Avx2Kernels {
+    using V = Avx2Ops;
+    #include "simd_kernels.inl"
+};
+
+VECS_SIMD_TARGET_END
+
+#endif // VECS_SIMD_X86
+
+[[nodiscard]]
+inline Level
+detect_level() noexcept {
+#if VECS_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return Level::AVX2;
+    }
+
+    return __builtin_cpu_supports("sse4.2") ? Level::SSE42 : Level::Scalar;
+#elif VECS_SIMD_X86 && defined(_MSC_VER)
+    int info[4]{};
+    __cpuid(info, 1);
+
+    bool const sse42 = (info[2] & (1 << 20)) != 0;
+    bool const fma   = (info[2] & (1 << 12)) != 0;
+    bool const os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+    __cpuidex(info, 7, 0);
+    bool const avx2 = (info[1] & (1 << 5)) != 0;
+
+    if (avx2 && fma && os_avx) {
+        return Level::AVX2;
+    }
+
+    return sse42 ? Level::SSE42 : Level::Scalar;
+#else
+    return Level::Scalar;
+#endif
+}
+
+// Best level of this CPU, detected once.
+[[nodiscard]]
+inline Level
+supported_level() noexcept {
+    static Level const level = detect_level();
+    return level;
+}
+
+inline std::atomic<Level> active { supported_level() };
+
+// Calls 'function(kernels)' with the kernel set of the active level.
+template <typename F>
+decltype(auto)
+dispatch(F&& function) {
+    switch (active.load(std::memory_order_relaxed)) {
+#if VECS_SIMD_X86
+        case Level::AVX2:  return function(Avx2Kernels{});
+        case Level::SSE42: return function(Sse42Kernels{});
+#endif
+        default:           return function(ScalarKernels{});
+    }
+}
+
+} // namespace detail
+
+// Level the kernels run at, the best one the CPU supports unless lowered with set_level().
+[[nodiscard]] inline Level level() noexcept { return detail::active.load(std::memory_order_relaxed); }
+[[nodiscard]] inline Level supported_level() noexcept { return detail::supported_level(); }
+
+// Runs every kernel at 'level' or lower, for testing and comparing levels. Returns the level in use.
+inline Level
+set_level(Level level) noexcept {
+    auto const used = std::min(level, supported_level());
+    detail::active.store(used, std::memory_order_relaxed);
+
+    return used;
+}
+
+// position[i] += velocity[i] * dt.
+inline void
+integrate(std::span<float> position, std::span<float const> velocity, float dt) noexcept {
+    assert(position.size() == velocity.size());
+
+    detail::dispatch([&](auto kernels) {
+        kernels.integrate(position.data(), velocity.data(), dt, position.size());
+    });
+}
+
+inline void
+integrate(Vec3Span<float> position, Vec3Span<float const> velocity, float dt) noexcept {
+    integrate(position.x, velocity.x, dt);
+    integrate(position.y, velocity.y, dt);
+    integrate(position.z, velocity.z, dt);
+}
+
+// min = center - half_extent, max = center + half_extent, axis by axis.
+inline void
+update_aabbs(Vec3Span<float const> center, Vec3Span<float const> half_extent, Vec3Span<float> min, Vec3Span<float> max) noexcept {
+    assert(center.valid() && half_extent.valid() && min.valid() && max.valid());
+    assert(half_extent.size() == center.size() && min.size() == center.size() && max.size() == center.size());
+
+    detail::dispatch([&](auto kernels) {
+        kernels.update_aabbs(center.x.data(), half_extent.x.data(), min.x.data(), max.x.data(), center.size());
+        kernels.update_aabbs(center.y.data(), half_extent.y.data(), min.y.data(), max.y.data(), center.size());
+        kernels.update_aabbs(center.z.data(), half_extent.z.data(), min.z.data(), max.z.data(), center.size());
+    });
+}
+
+// Scales every quaternion to unit length, zero quaternions stay zero.
+inline void
+normalize(QuatSpan<float> rotation) noexcept {
+    assert(rotation.valid());
+
+    detail::dispatch([&](auto kernels) {
+        kernels.normalize(rotation.x.data(), rotation.y.data(), rotation.z.data(), rotation.w.data(), rotation.size());
+    });
+}
+
+// matrix = translate(translation) * rotate(rotation) * scale(scale), 'rotation' must be unit quaternions.
+inline void
+compose(Vec3Span<float const> translation, QuatSpan<float const> rotation, Vec3Span<float const> scale, Mat4Span matrix) noexcept {
+    assert(translation.valid() && rotation.valid() && scale.valid() && matrix.valid());
+    assert(rotation.size() == translation.size() && scale.size() == translation.size() && matrix.size() == translation.size());
+
+    std::array const t { translation.x.data(), translation.y.data(), translation.z.data() };
+    std::array const r { rotation.x.data(), rotation.y.data(), rotation.z.data(), rotation.w.data() };
+    std::array const s { scale.x.data(), scale.y.data(), scale.z.data() };
+    std::array<float*, 16> m{};
+    std::transform(matrix.m.begin(), matrix.m.end(), m.begin(), [](auto const& column) { return column.data(); });
+
+    detail::dispatch([&](auto kernels) {
+        kernels.compose(t.data(), r.data(), s.data(), m.data(), translation.size());
+    });
+}
+
+/*
+    visible[i] = 1 when 'position[i]' is at most 'max_distance' away from
+    'center', 0 otherwise. Returns how many are visible.
+*/
+[[nodiscard]]
+inline size_t
+cull_distance(Vec3Span<float const> position, std::array<float, 3> const& center, float max_distance, std::span<uint8_t> visible) noexcept {
+    assert(position.valid() && visible.size() == position.size());
+
+    std::array const p { position.x.data(), position.y.data(), position.z.data() };
+
+    return detail::dispatch([&](auto kernels) {
+        return kernels.cull_distance(p.data(), center.data(), max_distance, visible.data(), position.size());
+    });
+}
+
+} // namespace vecs::simd
@@ -0,0 +1,133 @@
+// No include guard: simd.hpp includes this once per instruction set, inside
+// a struct that defines 'V' (the register operations of that set) and with
+// the matching target enabled. Kernels walk whole registers of 'V', then
+// the tail one lane at a time with ScalarOps.
+
+// Calls 'body(ops, i)' for every register (or lane) of [0, count).
+template <typename F>
+static void
+each_lane(size_t count, F&& body) {
+    size_t i{};
+
+    for (; i + V::WIDTH <= count; i += V::WIDTH) {
+        body(V{}, i);
+    }
+
+    for (; i < count; ++i) {
+        body(ScalarOps{}, i);
+    }
+}
+
+static void
+integrate(float* position, float const* velocity, float dt, size_t count) noexcept {
+    each_lane(count, [&](auto ops, size_t i) {
+        using O = decltype(ops);
+        O::store(position + i, O::fmadd(O::load(velocity + i), O::set1(dt), O::load(position + i)));
+    });
+}
+
+static void
+update_aabbs(float const* center, float const* half_extent, float* min, float* max, size_t count) noexcept {
+    each_lane(count, [&](auto ops, size_t i) {
+        using O = decltype(ops);
+        auto const c = O::load(center + i);
+        auto const e = O::load(half_extent + i);
+
+        O::store(min + i, O::sub(c, e));
+        O::store(max + i, O::add(c, e));
+    });
+}
+
+static void
+normalize(float* x, float* y, float* z, float* w, size_t count) noexcept {
+    each_lane(count, [&](auto ops, size_t i) {
+        using O = decltype(ops);
+        auto const qx = O::load(x + i);
+        auto const qy = O::load(y + i);
+        auto const qz = O::load(z + i);
+        auto const qw = O::load(w + i);
+
+        auto const length2 = O::fmadd(qw, qw, O::fmadd(qz, qz, O::fmadd(qy, qy, O::mul(qx, qx))));
+        auto const inverse = O::div(O::set1(1.0f), O::sqrt(O::max(length2, O::set1(std::numeric_limits<float>::min()))));
+
+        O::store(x + i, O::mul(qx, inverse));
+        O::store(y + i, O::mul(qy, inverse));
+        O::store(z + i, O::mul(qz, inverse));
+        O::store(w + i, O::mul(qw, inverse));
+    });
+}
+
+static void
+compose(float const* const* translation, float const* const* rotation, float const* const* scale, float* const* matrix, size_t count) noexcept {
+    each_lane(count, [&](auto ops, size_t i) {
+        using O = decltype(ops);
+        auto const x = O::load(rotation[0] + i);
+        auto const y = O::load(rotation[1] + i);
+        auto const z = O::load(rotation[2] + i);
+        auto const w = O::load(rotation[3] + i);
+
+        auto const x2 = O::add(x, x);
+        auto const y2 = O::add(y, y);
+        auto const z2 = O::add(z, z);
+
+        auto const xx = O::mul(x, x2);
+        auto const yy = O::mul(y, y2);
+        auto const zz = O::mul(z, z2);
+        auto const xy = O::mul(x, y2);
+        auto const xz = O::mul(x, z2);
+        auto const yz = O::mul(y, z2);
+        auto const wx = O::mul(w, x2);
+        auto const wy = O::mul(w, y2);
+        auto const wz = O::mul(w, z2);
+
+        auto const one = O::set1(1.0f);
+        auto const zero = O::set1(0.0f);
+        auto const sx = O::load(scale[0] + i);
+        auto const sy = O::load(scale[1] + i);
+        auto const sz = O::load(scale[2] + i);
+
+        // Column-major, columns are the scaled rotation axes, then the translation.
+        O::store(matrix[0] + i, O::mul(O::sub(one, O::add(yy, zz)), sx));
+        O::store(matrix[1] + i, O::mul(O::add(xy, wz), sx));
+        O::store(matrix[2] + i, O::mul(O::sub(xz, wy), sx));
+        O::store(matrix[3] + i, zero);
+
+        O::store(matrix[4] + i, O::mul(O::sub(xy, wz), sy));
+        O::store(matrix[5] + i, O::mul(O::sub(one, O::add(xx, zz)), sy));
+        O::store(matrix[6] + i, O::mul(O::add(yz, wx), sy));
+        O::store(matrix[7] + i, zero);
+
+        O::store(matrix[8] + i, O::mul(O::add(xz, wy), sz));
+        O::store(matrix[9] + i, O::mul(O::sub(yz, wx), sz));
+        O::store(matrix[10] + i, O::mul(O::sub(one, O::add(xx, yy)), sz));
+        O::store(matrix[11] + i, zero);
+
+        O::store(matrix[12] + i, O::load(translation[0] + i));
+        O::store(matrix[13] + i, O::load(translation[1] + i));
+        O::store(matrix[14] + i, O::load(translation[2] + i));
+        O::store(matrix[15] + i, one);
+    });
+}
+
+static size_t
+cull_distance(float const* const* position, float const* center, float max_distance, uint8_t* visible, size_t count) noexcept {
+    size_t total{};
+
+    each_lane(count, [&](auto ops, size_t i) {
+        using O = decltype(ops);
+        auto const dx = O::sub(O::load(position[0] + i), O::set1(center[0]));
+        auto const dy = O::sub(O::load(position[1] + i), O::set1(center[1]));
+        auto const dz = O::sub(O::load(position[2] + i), O::set1(center[2]));
+        auto const distance2 = O::fmadd(dz, dz, O::fmadd(dy, dy, O::mul(dx, dx)));
+
+        auto const bits = O::mask_bits(O::less_equal(distance2, O::set1(max_distance * max_distance)));
+
+        for (size_t lane{}; lane < O::WIDTH; ++lane) {
+            visible[i + lane] = static_cast<uint8_t>((bits >> lane) & 1u);
+        }
+
+        total += static_cast<size_t>(std::popcount(bits));
+    });
+
+    return total;
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+// std
+#include <span>
+#include <tuple>
+#include <array>
+#include <utility>
+#include <optional>
+#include <cstddef>
+#include <type_traits>
+
+/*
+    Opt-in field splitting (AoS to SoA) for archetype components.
+
+    VECS_SOA_FIELDS(Type, fields...) lists the fields of 'Type', the World
+    then stores every field in its own packed array inside the archetype
+    chunks instead of storing whole 'Type' values, so a system reading
+    only 'x' streams only the bytes of 'x'. Use it at global scope, after
+    'Type' is complete, listing every data member of 'Type' (a member left
+    out is a compile error, for types with constructors list them in
+    declaration order so the check can compare sizes):
+
+        struct Position { float x, y, z; };
+        VECS_SOA_FIELDS(Position, x, y, z);
+
+    It works for types you cannot edit too (VECS_SOA_FIELDS(glm::vec3, x,
+    y, z)). Split types must be trivially copyable, fields are copied one
+    by one with memcpy, and use archetype storage.
+
+    User code never sees a 'Type&' of a split type, it gets proxies with
+    one member per field, named like the fields:
+    - soa_ref_t<Type> (soa_ref_t<Type const>): references, 'p.x += 1'.
+    - soa_spans_t<Type> (soa_spans_t<Type const>): spans over the packed
+      field arrays of a chunk, 'p.x[i] += 1', see View::each_chunk().
+*/
+
+// Calls 'macro(type, field)' for every field, up to 16 fields.
+#define VECS_DETAIL_EXPAND(x) x
+#define VECS_DETAIL_FOR_EACH_1(m, t, a) m(t, a)
+#define VECS_DETAIL_FOR_EACH_2(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_1(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_3(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_2(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_4(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_3(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_5(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_4(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_6(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_5(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_7(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_6(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_8(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_7(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_9(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_8(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_10(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_9(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_11(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_10(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_12(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_11(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_13(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_12(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_14(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_13(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_15(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_14(m, t, __VA_ARGS__))
+#define VECS_DETAIL_FOR_EACH_16(m, t, a, ...) m(t, a) VECS_DETAIL_EXPAND(VECS_DETAIL_FOR_EACH_15(m, t, __VA_ARGS__))
+
+#define VECS_DETAIL_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, name, ...) name
+#define VECS_DETAIL_FOR_EACH(m, t, ...)                                                                  \
+    VECS_DETAIL_EXPAND(VECS_DETAIL_PICK(__VA_ARGS__,                                                     \
+        VECS_DETAIL_FOR_EACH_16, VECS_DETAIL_FOR_EACH_15, VECS_DETAIL_FOR_EACH_14, VECS_DETAIL_FOR_EACH_13, \
+        VECS_DETAIL_FOR_EACH_12, VECS_DETAIL_FOR_EACH_11, VECS_DETAIL_FOR_EACH_10, VECS_DETAIL_FOR_EACH_9,  \
+        VECS_DETAIL_FOR_EACH_8, VECS_DETAIL_FOR_EACH_7, VECS_DETAIL_FOR_EACH_6, VECS_DETAIL_FOR_EACH_5,     \
+        VECS_DETAIL_FOR_EACH_4, VECS_DETAIL_FOR_EACH_3, VECS_DETAIL_FOR_EACH_2, VECS_DETAIL_FOR_EACH_1)(m, t, __VA_ARGS__))
+
+#define VECS_DETAIL_SOA_MEMBER(type, field) &type::field,
+#define VECS_DETAIL_SOA_FIELD(type, field) Q<decltype(type::field)> field;
+
+#define VECS_SOA_FIELDS(Type, ...)                                                                     \
+    template <>                                                                                        \
+    struct vecs::soa_fields<Type> {                                                                    \
+        static constexpr auto MEMBERS = std::tuple { VECS_DETAIL_FOR_EACH(VECS_DETAIL_SOA_MEMBER, Type, __VA_ARGS__) }; \
+                                                                                                       \
+        template <template <typename> typename Q>                                                      \
+        struct Fields {                                                                                \
+            VECS_DETAIL_FOR_EACH(VECS_DETAIL_SOA_FIELD, Type, __VA_ARGS__)                             \
+        };                                                                                             \
+                                                                                                       \
+        static_assert(::vecs::detail::soa_covers_v<Type, decltype(MEMBERS), Fields<::vecs::detail::soa_value_q>>, \
+            "VECS_SOA_FIELDS must list every data member of " #Type ".");                             \
+    }
+
+namespace vecs {
+
+/*
+    Field list of a split type, specialized by VECS_SOA_FIELDS: the member
+    pointers in 'MEMBERS', and 'Fields<Q>', one 'Q<field type>' member per
+    field with the field's name, in the same order.
+*/
+template <typename T>
+struct soa_fields;
+
+template <typename T>
+concept SoaComponent = requires { soa_fields<std::remove_const_t<T>>::MEMBERS; };
+
+template <typename T>
+inline constexpr bool is_soa_component_v = SoaComponent<T>;
+
+// Size and alignment of one field, all the type-erased storage needs.
+struct FieldInfo {
+    size_t size;
+    size_t alignment;
+};
+
+namespace detail {
+
+template <typename U> using soa_value_q = U;
+template <typename U> using soa_ref_q   = U&;
+template <typename U> using soa_cref_q  = U const&;
+template <typename U> using soa_span_q  = std::span<U>;
+template <typename U> using soa_cspan_q = std::span<U const>;
+
+template <typename T>
+using soa_members_t = std::remove_const_t<decltype(soa_fields<std::remove_const_t<T>>::MEMBERS)>;
+
+template <typename T>
+inline constexpr size_t soa_field_count_v = std::tuple_size_v<soa_members_t<T>>;
+
+template <typename T>
+using soa_sequence_t = std::make_index_sequence<soa_field_count_v<T>>;
+
+template <typename TMember>
+struct member_traits;
+
+template <typename TClass, typename TField>
+struct member_traits<TField TClass::*> {
+    using field_t = TField;
+};
+
+// Type of field 'I' of 'T', const when 'T' is.
+template <typename T, size_t I>
+using soa_field_t = std::conditional_t<
+    std::is_const_v<T>,
+    typename member_traits<std::tuple_element_t<I, soa_members_t<T>>>::field_t const,
+    typename member_traits<std::tuple_element_t<I, soa_members_t<T>>>::field_t
+>;
+
+template <typename T, typename = std::make_index_sequence<soa_field_count_v<T>>>
+struct soa_pointers;
+
+template <typename T, size_t... Is>
+struct soa_pointers<T, std::index_sequence<Is...>> {
+    using type = std::tuple<soa_field_t<T, Is>*...>;
+};
+
+// First element of every field array, where a view reads a split 'T' from.
+template <typename T>
+using soa_pointers_t = typename soa_pointers<T>::type;
+
+// Converts to any field type, one per member when brace initializing an aggregate.
+struct AnyField {
+    template <typename U>
+    operator U() const noexcept;
+};
+
+template <typename T, size_t... Is>
+[[nodiscard]]
+consteval bool
+brace_initializable(std::index_sequence<Is...>) noexcept {
+    return requires { T { (static_cast<void>(Is), AnyField{})... }; };
+}
+
+/*
+    Whether 'TMembers' (the tuple of member pointers of VECS_SOA_FIELDS)
+    names every data member of 'T': an aggregate must take exactly one
+    initializer per field, other types must be as big as 'TMirror', a
+    struct of the listed fields in the listed order.
+*/
+template <typename T, typename TMembers, typename TMirror>
+[[nodiscard]]
+consteval bool
+soa_covers() noexcept {
+    constexpr auto count = std::tuple_size_v<std::remove_const_t<TMembers>>;
+
+    if constexpr (std::is_aggregate_v<T>) {
+        return brace_initializable<T>(std::make_index_sequence<count>{})
+            && !brace_initializable<T>(std::make_index_sequence<count + 1>{});
+    }
+    else {
+        return sizeof(TMirror) == sizeof(T);
+    }
+}
+
+template <typename T, typename TMembers, typename TMirror>
+inline constexpr bool soa_covers_v = soa_covers<T, TMembers, TMirror>();
+
+template <typename T, size_t... Is>
+[[nodiscard]]
+constexpr std::array<FieldInfo, sizeof...(Is)>
+soa_field_infos(std::index_sequence<Is...>) noexcept {
+    return { FieldInfo { sizeof(soa_field_t<T, Is>), alignof(soa_field_t<T, Is>) }... };
+}
+
+template <typename T, template <typename> typename Q, template <typename> typename QConst>
+using soa_fields_t = std::conditional_t<
+    std::is_const_v<T>,
+    typename soa_fields<std::remove_const_t<T>>::template Fields<QConst>,
+    typename soa_fields<std::remove_const_t<T>>::template Fields<Q>
+>;
+
+template <typename T, size_t... Is>
+[[nodiscard]]
+auto
+soa_ref_at(soa_pointers_t<T> const& pointers, size_t row, std::index_sequence<Is...>) noexcept {
+    return soa_fields_t<T, soa_ref_q, soa_cref_q> { std::get<Is>(pointers)[row]... };
+}
+
+template <typename T, size_t... Is>
+[[nodiscard]]
+auto
+soa_spans_at(soa_pointers_t<T> const& pointers, size_t count, std::index_sequence<Is...>) noexcept {
+    return soa_fields_t<T, soa_span_q, soa_cspan_q> { std::span { std::get<Is>(pointers), count }... };
+}
+
+template <typename T, size_t... Is>
+void
+soa_store(soa_pointers_t<T> const& pointers, size_t row, T const& value, std::index_sequence<Is...>) noexcept {
+    ((std::get<Is>(pointers)[row] = value.*std::get<Is>(soa_fields<T>::MEMBERS)), ...);
+}
+
+} // namespace detail
+
+// References to the fields of one split 'T' ('p.x').
+template <SoaComponent T>
+using soa_ref_t = detail::soa_fields_t<T, detail::soa_ref_q, detail::soa_cref_q>;
+
+// Spans over the field arrays of one chunk ('p.x[i]').
+template <SoaComponent T>
+using soa_spans_t = detail::soa_fields_t<T, detail::soa_span_q, detail::soa_cspan_q>;
+
+/*
+    What World::get_component() returns for a split 'T': null, or a
+    soa_ref_t<T> reached through '->' and '*', so code reads the same as
+    with a plain 'T*'.
+*/
+template <SoaComponent T>
+class SoaPtr {
+    std::optional<soa_ref_t<T>> _ref{};
+
+public:
+    SoaPtr() noexcept = default;
+    SoaPtr(std::nullptr_t) noexcept {}
+    explicit SoaPtr(soa_ref_t<T> ref) noexcept : _ref(ref) {}
+
+    [[nodiscard]] inline soa_ref_t<T> const* operator->() const noexcept { return &*_ref; }
+    [[nodiscard]] inline soa_ref_t<T> const& operator*() const noexcept { return *_ref; }
+    [[nodiscard]] inline explicit operator bool() const noexcept { return _ref.has_value(); }
+    [[nodiscard]] inline bool operator==(std::nullptr_t) const noexcept { return !_ref.has_value(); }
+};
+
+} // namespace vecs
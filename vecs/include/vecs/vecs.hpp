@@ -5,13 +5,9 @@
 #include "utils/memory_viewer.hpp"
 #include "debug.hpp"
 #include "result.hpp"
-
-namespace vecs {
-
-struct World {
-
-    
-
-};
-
-} // namespace vecs
\ No newline at end of file
+#include "soa.hpp"
+#include "entities.hpp"
+#include "job_system.hpp"
+#include "command_buffer.hpp"
+#include "scheduler.hpp"
+#include "simd.hpp"
\ No newline at end of file